@@ -0,0 +1,173 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QLockFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <sys/wait.h>
+
+#include "kconfiginibackendreader_p.h"
+
+using namespace std::chrono_literals;
+
+// Writers use QLockFile, readers take a shared flock() on its file
+class FlockLockFileTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+        m_lockPath = m_dir.filePath(QStringLiteral("testrc.lock"));
+        QFile::remove(m_lockPath);
+    }
+
+    void testNoLockFile()
+    {
+        // nobody is writing, a reader neither waits nor creates the lock file
+        FlockLockFile reader(m_lockPath);
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(reader.tryLock(5s));
+        QVERIFY(timer.elapsed() < 1000);
+        QVERIFY(!reader.isLocked());
+        QCOMPARE(reader.error(), QLockFile::NoError);
+        QVERIFY(!QFile::exists(m_lockPath));
+    }
+
+    void testSharedLocksDontBlock()
+    {
+        // e.g. left behind by a crashed writer
+        QFile lockFile(m_lockPath);
+        QVERIFY(lockFile.open(QIODevice::WriteOnly));
+        lockFile.close();
+
+        FlockLockFile reader1(m_lockPath);
+        FlockLockFile reader2(m_lockPath);
+        QVERIFY(reader1.tryLock(0ms));
+        QVERIFY(reader1.isLocked());
+        QVERIFY(reader2.tryLock(0ms));
+        QVERIFY(reader2.isLocked());
+
+        // readers leave the file alone
+        reader1.unlock();
+        reader2.unlock();
+        QVERIFY(QFile::exists(m_lockPath));
+    }
+
+    void testSharedWaitsForQLockFile()
+    {
+        QLockFile writer(m_lockPath);
+        QVERIFY(writer.tryLock(0));
+
+        FlockLockFile reader(m_lockPath);
+        QVERIFY(!reader.tryLock(0ms));
+        QCOMPARE(reader.error(), QLockFile::LockFailedError);
+
+        auto unlocked = QtConcurrent::run([&writer] {
+            QThread::msleep(200);
+            writer.unlock();
+        });
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(reader.tryLock(5s));
+        QVERIFY(timer.elapsed() >= 150);
+        unlocked.waitForFinished();
+        QCOMPARE(reader.error(), QLockFile::NoError);
+        reader.unlock();
+        QVERIFY(!QFile::exists(m_lockPath));
+    }
+
+    void testQLockFileIgnoresReaders()
+    {
+        // a writer is excluded by other writers only, readers never hold a lock file of their own
+        QLockFile writer1(m_lockPath);
+        QVERIFY(writer1.tryLock(0));
+        QLockFile writer2(m_lockPath);
+        QVERIFY(!writer2.tryLock(0));
+        writer1.unlock();
+
+        FlockLockFile reader(m_lockPath);
+        QVERIFY(reader.tryLock(0ms));
+        QVERIFY(!reader.isLocked());
+        QVERIFY(writer2.tryLock(0));
+        writer2.unlock();
+    }
+
+    void testRetryAfterReplacement()
+    {
+        // the reader waits on a lock file that is replaced before it is released, it has to wait for the new one too
+        const QByteArray path = QFile::encodeName(m_lockPath);
+        const int oldFd = ::open(path.constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        QVERIFY(oldFd >= 0);
+        QCOMPARE(::flock(oldFd, LOCK_EX), 0);
+
+        FlockLockFile reader(m_lockPath);
+        QElapsedTimer timer;
+        timer.start();
+        auto locked = QtConcurrent::run([&reader] {
+            return reader.tryLock(5s);
+        });
+        QThread::msleep(100);
+
+        const QByteArray newPath = path + ".new";
+        const int newFd = ::open(newPath.constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        QVERIFY(newFd >= 0);
+        QCOMPARE(::flock(newFd, LOCK_EX), 0);
+        QCOMPARE(::rename(newPath.constData(), path.constData()), 0);
+        ::close(oldFd);
+
+        QThread::msleep(200);
+        QVERIFY(!locked.isFinished());
+        ::close(newFd);
+
+        QVERIFY(locked.result());
+        QVERIFY(timer.elapsed() >= 250);
+        QVERIFY(reader.isLocked());
+        reader.unlock();
+    }
+
+    void testCrashedWriter()
+    {
+        const pid_t pid = fork();
+        QVERIFY(pid >= 0);
+        if (pid == 0) {
+            QLockFile writer(m_lockPath);
+            // exit without unlock(), like a crash would
+            _exit(writer.tryLock(0) ? 0 : 1);
+        }
+        int status = 0;
+        QCOMPARE(waitpid(pid, &status, 0), pid);
+        QVERIFY(WIFEXITED(status));
+        QCOMPARE(WEXITSTATUS(status), 0);
+
+        // the file stays, but the kernel released the lock, so readers don't wait for the stale lock
+        QVERIFY(QFile::exists(m_lockPath));
+        FlockLockFile reader(m_lockPath);
+        QVERIFY(reader.tryLock(0ms));
+        QVERIFY(reader.isLocked());
+        reader.unlock();
+
+        // and QLockFile removes it since its process is gone
+        QLockFile writer(m_lockPath);
+        QVERIFY(writer.tryLock(0));
+        writer.unlock();
+        QVERIFY(!QFile::exists(m_lockPath));
+    }
+
+private:
+    QTemporaryDir m_dir;
+    QString m_lockPath;
+};
+
+QTEST_GUILESS_MAIN(FlockLockFileTest)
+
+#include "flocklockfiletest.moc"
@@ -0,0 +1,176 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QStandardPaths>
+#include <QTest>
+#include <QUrl>
+
+#include <KAuthorized>
+#include <KConfig>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <kconfigcore_export.h>
+
+// Exported from kauthorized.cpp for KIO and unit tests, not part of the public API
+KCONFIGCORE_EXPORT void loadUrlActionRestrictions(const KConfigGroup &cg);
+namespace KAuthorizedInternal
+{
+KCONFIGCORE_EXPORT void allowUrlAction(const QString &action, const QUrl &baseURL, const QUrl &destURL);
+KCONFIGCORE_EXPORT qsizetype allowedUrlActionCount();
+KCONFIGCORE_EXPORT void setMaxAllowedUrlActions(qsizetype maxCount);
+KCONFIGCORE_EXPORT bool authorizeUrlAction(const QString &action, const QUrl &baseURL, const QUrl &destURL, const QString &baseClass, const QString &destClass);
+}
+
+static const QString s_local(QStringLiteral(":local"));
+static const QString s_internet(QStringLiteral(":internet"));
+
+class KAuthorizedTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        // KAuthorized only checks action restrictions if there were any when it was first used
+        KConfigGroup actionRestrictions(KSharedConfig::openConfig(), QStringLiteral("KDE Action Restrictions"));
+        actionRestrictions.writeEntry("kauthorizedtest_unused", false);
+    }
+
+    void init()
+    {
+        // only the built-in rules
+        KConfig config(QString(), KConfig::SimpleConfig);
+        loadUrlActionRestrictions(config.group(QStringLiteral("KDE URL Restrictions")));
+    }
+
+    void testDefaultRules()
+    {
+        const QUrl web(QStringLiteral("https://kde.org/index.html"));
+        const QUrl file(QStringLiteral("file:///tmp/foo"));
+
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("open"), web, file, s_internet, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("list"), file, web, s_local, s_internet));
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("unknown"), file, file, s_local, s_local));
+
+        // internet protocols may not redirect to local files, local ones may redirect anywhere
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file, s_internet, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), file, web, s_local, s_internet));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, QUrl(QStringLiteral("mailto:someone@kde.org")), s_internet, QString()));
+        // redirects within the same protocol class are fine
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"),
+                                                        web,
+                                                        QUrl(QStringLiteral("ftp://ftp.kde.org/pub")),
+                                                        s_internet,
+                                                        s_internet));
+        // an empty destination is always allowed
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, QUrl(), s_internet, QString()));
+    }
+
+    void testConfiguredRules()
+    {
+        KConfig config(QString(), KConfig::SimpleConfig);
+        KConfigGroup cg = config.group(QStringLiteral("KDE URL Restrictions"));
+        cg.writeEntry("rule_count", 3);
+        // the last matching rule decides: listing files is denied except below /tmp/allowed
+        cg.writeEntry("rule_1", QStringList{QStringLiteral("list"), {}, {}, {}, QStringLiteral("file"), {}, {}, QStringLiteral("false")});
+        cg.writeEntry("rule_2", QStringList{QStringLiteral("list"), {}, {}, {}, QStringLiteral("file"), {}, QStringLiteral("/tmp/allowed"), QStringLiteral("true")});
+        // exact protocol match, does not apply to "https"
+        cg.writeEntry("rule_3", QStringList{QStringLiteral("open"), {}, {}, {}, QStringLiteral("http!"), {}, {}, QStringLiteral("false")});
+        loadUrlActionRestrictions(cg);
+
+        const QUrl base(QStringLiteral("file:///"));
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("list"), base, QUrl(QStringLiteral("file:///tmp")), s_local, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("list"), base, QUrl(QStringLiteral("file:///tmp/allowed/sub")), s_local, s_local));
+        // paths are cleaned before matching
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("list"), base, QUrl(QStringLiteral("file:///tmp/allowed/../x")), s_local, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("list"), base, QUrl(QStringLiteral("https://kde.org")), s_local, s_internet));
+
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("open"), base, QUrl(QStringLiteral("http://kde.org")), s_local, s_internet));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("open"), base, QUrl(QStringLiteral("https://kde.org")), s_local, s_internet));
+    }
+
+    void testAllowUrlAction()
+    {
+        const QUrl web(QStringLiteral("https://kde.org/download"));
+        const QUrl file(QStringLiteral("file:///tmp/download"));
+
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file, s_internet, s_local));
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file);
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file, s_internet, s_local));
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, QUrl(QStringLiteral("file:///tmp/other")), s_internet, s_local));
+        // path rules match by prefix
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, QUrl(QStringLiteral("file:///tmp/download/a")), s_internet, s_local));
+    }
+
+    void testAllowedUrlActionsBounded()
+    {
+        const QUrl web(QStringLiteral("https://kde.org/"));
+        auto file = [](int i) {
+            return QUrl(QStringLiteral("file:///tmp/download%1").arg(i));
+        };
+
+        QCOMPARE(KAuthorizedInternal::allowedUrlActionCount(), qsizetype(0));
+        KAuthorizedInternal::setMaxAllowedUrlActions(2);
+
+        // allowing the same again doesn't add a rule
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(1));
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(1));
+        QCOMPARE(KAuthorizedInternal::allowedUrlActionCount(), qsizetype(1));
+
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(2));
+        // checking doesn't change which rule is dropped first
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(1), s_internet, s_local));
+        // allowing again makes file(1) the most recent rule, so file(2) is dropped next
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(1));
+        KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(3));
+        QCOMPARE(KAuthorizedInternal::allowedUrlActionCount(), qsizetype(2));
+
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(1), s_internet, s_local));
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(2), s_internet, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(3), s_internet, s_local));
+
+        KAuthorizedInternal::setMaxAllowedUrlActions(0);
+        for (int i = 0; i < 10; ++i) {
+            KAuthorizedInternal::allowUrlAction(QStringLiteral("redirect"), web, file(10 + i));
+        }
+        QCOMPARE(KAuthorizedInternal::allowedUrlActionCount(), qsizetype(12));
+
+        // dropping rules drops them from the index used for anything but exact checks
+        KAuthorizedInternal::setMaxAllowedUrlActions(1);
+        QCOMPARE(KAuthorizedInternal::allowedUrlActionCount(), qsizetype(1));
+        QVERIFY(!KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(3), s_internet, s_local));
+        QVERIFY(KAuthorizedInternal::authorizeUrlAction(QStringLiteral("redirect"), web, file(19), s_internet, s_local));
+        KAuthorizedInternal::setMaxAllowedUrlActions(0);
+    }
+
+    void testRestrictionsCopied()
+    {
+        KConfigGroup actionRestrictions(KSharedConfig::openConfig(), QStringLiteral("KDE Action Restrictions"));
+        QVERIFY(KAuthorized::authorize(KAuthorized::SHELL_ACCESS));
+        QVERIFY(KAuthorized::authorizeAction(QStringLiteral("open_with")));
+
+        // restrictions copied into the main config take effect like written ones
+        KConfig other(QString(), KConfig::SimpleConfig);
+        KConfigGroup otherRestrictions = other.group(QStringLiteral("KDE Action Restrictions"));
+        otherRestrictions.writeEntry("shell_access", false);
+        otherRestrictions.writeEntry("action/open_with", false);
+        otherRestrictions.copyTo(&actionRestrictions);
+        QVERIFY(!KAuthorized::authorize(KAuthorized::SHELL_ACCESS));
+        QVERIFY(!KAuthorized::authorize(QStringLiteral("shell_access")));
+        QVERIFY(!KAuthorized::authorizeAction(QStringLiteral("open_with")));
+
+        actionRestrictions.deleteEntry("shell_access");
+        actionRestrictions.deleteEntry("action/open_with");
+        QVERIFY(KAuthorized::authorize(KAuthorized::SHELL_ACCESS));
+        QVERIFY(KAuthorized::authorizeAction(QStringLiteral("open_with")));
+    }
+};
+
+QTEST_GUILESS_MAIN(KAuthorizedTest)
+
+#include "kauthorizedtest.moc"
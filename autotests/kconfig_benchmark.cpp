@@ -6,16 +6,333 @@
 
 #include <KConfig>
 #include <KConfigGroup>
+#include <KCoreConfigSkeleton>
+#include <KDesktopFile>
+#include <KDesktopFileIndex>
+#include <KDesktopFileRecord>
+#include <KSharedConfig>
 
+#include <QDebug>
+#include <QDir>
 #include <QObject>
 #include <QStandardPaths>
 #include <QTest>
+#include <QUrl>
+
+#include <kconfigcore_export.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Counts the allocations done through operator new, e.g. for the nodes of the entry maps.
+// The data of Qt containers is allocated with malloc() and isn't counted. The libraries
+// only use this replacement where operator new is resolved across shared objects, e.g. not on Windows.
+static std::atomic<quint64> s_allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(KCONFIG_BENCHMARK_COUNT_MALLOC) && defined(__GLIBC__)
+// With the CMake option KCONFIG_BENCHMARK_COUNT_MALLOC, malloc() is replaced as well, so that
+// the data of Qt containers is counted too. The replacements forward to the internal allocator
+// functions of glibc, which breaks ASan and other tools replacing malloc(), so this is off by default.
+#define KCONFIG_BENCHMARK_COUNTS_MALLOC
+static std::atomic<quint64> s_mallocCount{0};
+
+extern "C" {
+void *__libc_malloc(size_t size) noexcept;
+void *__libc_calloc(size_t count, size_t size) noexcept;
+void *__libc_realloc(void *ptr, size_t size) noexcept;
+void __libc_free(void *ptr) noexcept;
+
+void *malloc(size_t size) noexcept
+{
+    s_mallocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    s_mallocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+    s_mallocCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) noexcept
+{
+    __libc_free(ptr);
+}
+}
+#endif
+
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+// The heap in use is read from the statistics of glibc
+#define KCONFIG_BENCHMARK_HAS_MALLINFO
+#include <malloc.h>
+#endif
+#endif
+
+// Exported from kauthorized.cpp for KIO and unit tests, not part of the public API
+KCONFIGCORE_EXPORT void loadUrlActionRestrictions(const KConfigGroup &cg);
+namespace KAuthorizedInternal
+{
+KCONFIGCORE_EXPORT bool authorizeUrlAction(const QString &action, const QUrl &baseURL, const QUrl &destURL, const QString &baseClass, const QString &destClass);
+}
+// Exported from kconfigini.cpp for this benchmark
+namespace KConfigIniBackendInternal
+{
+KCONFIGCORE_EXPORT void setSharedDataPoolEnabled(bool enabled);
+KCONFIGCORE_EXPORT void setForeignTranslationRejectEnabled(bool enabled);
+}
 
 // clazy:excludeall=non-pod-global-static
 static const QString s_test_subdir{QStringLiteral("kconfigtest_subdir/")};
 static const QString s_kconfig_test_subdir(s_test_subdir + QLatin1String("kconfigtest"));
 static const QString s_string_entry1(QStringLiteral("hello"));
 
+namespace
+{
+// Shapes of the synthetic configs, chosen to resemble real world rc files
+enum class Shape {
+    ManySmallGroups, // e.g. plasma-org.kde.plasma.desktop-appletsrc
+    FewHugeGroups, // e.g. recent files and history lists
+    DeepNesting, // e.g. per-activity/per-screen containment configs
+    Localized, // e.g. .desktop files with dozens of translations
+    Expansions, // values using $e dollar expansion
+};
+} // namespace
+
+Q_DECLARE_METATYPE(Shape)
+
+namespace
+{
+struct ShapeInfo {
+    int groups;
+    int keysPerGroup;
+};
+
+ShapeInfo shapeInfo(Shape shape)
+{
+    switch (shape) {
+    case Shape::ManySmallGroups:
+        return {2000, 5};
+    case Shape::FewHugeGroups:
+        return {3, 5000};
+    case Shape::DeepNesting:
+        return {500, 10};
+    case Shape::Localized:
+        return {20, 20};
+    case Shape::Expansions:
+        return {100, 20};
+    }
+    return {};
+}
+
+QString groupName(Shape shape, int group)
+{
+    if (shape == Shape::DeepNesting) {
+        // five levels of nesting, sharing the upper levels between groups
+        return QStringLiteral("Containments][%1][Applets][%2][Configuration][General%3").arg(group / 100).arg(group / 10).arg(group);
+    }
+    return QStringLiteral("Group %1").arg(group);
+}
+
+QString keyName(int key)
+{
+    return QStringLiteral("Key%1").arg(key);
+}
+
+// Returns false if the file couldn't be written
+[[nodiscard]] bool writeSyntheticConfig(const QString &path, Shape shape)
+{
+    static const char *const locales[] = {
+        "ar", "ca", "cs", "da", "de", "el", "en_GB", "es", "et", "eu", "fi", "fr", "gl", "he", "hu", "ia", "it", "ja",
+        "ko", "lt", "nl", "nn", "pa", "pl", "pt", "pt_BR", "ro", "ru", "sk", "sl", "sv", "ta", "tr", "uk", "zh_CN", "zh_TW",
+    };
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Could not write" << path << file.errorString();
+        return false;
+    }
+
+    const ShapeInfo info = shapeInfo(shape);
+    for (int g = 0; g < info.groups; ++g) {
+        file.write("[" + groupName(shape, g).toUtf8() + "]\n");
+        for (int k = 0; k < info.keysPerGroup; ++k) {
+            const QByteArray key = keyName(k).toUtf8();
+            switch (shape) {
+            case Shape::Localized:
+                file.write(key + "=Untranslated value " + QByteArray::number(k) + "\n");
+                for (const char *locale : locales) {
+                    file.write(key + "[" + locale + "]=Translated value " + QByteArray::number(k) + " for " + locale + "\n");
+                }
+                break;
+            case Shape::Expansions:
+                file.write(key + "[$e]=$HOME/.local/share/item" + QByteArray::number(k) + "\n");
+                break;
+            default:
+                file.write(key + "=value " + QByteArray::number(g * info.keysPerGroup + k) + "\n");
+                break;
+            }
+        }
+    }
+    return file.flush() && file.error() == QFile::NoError;
+}
+
+QString syntheticConfigPath(const QString &name)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QLatin1Char('/') + s_test_subdir + name;
+}
+
+const std::pair<const char *, Shape> s_shapeRows[] = {
+    {"many small groups", Shape::ManySmallGroups},
+    {"few huge groups", Shape::FewHugeGroups},
+    {"deep nesting", Shape::DeepNesting},
+    {"localized", Shape::Localized},
+    {"expansions", Shape::Expansions},
+};
+
+void addShapeRows()
+{
+    QTest::addColumn<Shape>("shape");
+
+    for (const auto &[name, shape] : s_shapeRows) {
+        QTest::newRow(name) << shape;
+    }
+}
+
+// Every shape with and without sharing the data of parsed entries
+void addPoolRows()
+{
+    QTest::addColumn<Shape>("shape");
+    QTest::addColumn<bool>("pool");
+
+    for (const auto &[name, shape] : s_shapeRows) {
+        QTest::newRow(name) << shape << true;
+        QTest::addRow("%s, no pool", name) << shape << false;
+    }
+}
+
+QString shapeFile(Shape shape)
+{
+    return syntheticConfigPath(QStringLiteral("benchmark_shape%1rc").arg(int(shape)));
+}
+
+// Number of entries of group and of all its subgroups
+qsizetype entryCount(const KConfigGroup &group)
+{
+    qsizetype count = group.keyList().size();
+    const QStringList groups = group.groupList();
+    for (const QString &name : groups) {
+        count += entryCount(group.group(name));
+    }
+    return count;
+}
+
+qsizetype entryCount(const KConfig &config)
+{
+    qsizetype count = 0;
+    const QStringList groups = config.groupList();
+    for (const QString &name : groups) {
+        count += entryCount(config.group(name));
+    }
+    return count;
+}
+
+#ifdef KCONFIG_BENCHMARK_HAS_MALLINFO
+// Bytes of heap in use, including the large blocks glibc maps separately
+quint64 heapInUse()
+{
+    const struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+#endif
+
+struct HeapUsage {
+    quint64 allocations;
+    quint64 bytes;
+    qsizetype entries;
+};
+
+// What parsing the config of shape into a new KConfig requests from malloc(), if that is counted,
+// and how much heap the KConfig keeps in use afterwards, including the nodes of its entry map
+HeapUsage parseHeapUsage(Shape shape, bool pool)
+{
+    HeapUsage usage{0, 0, 0};
+    KConfigIniBackendInternal::setSharedDataPoolEnabled(pool);
+#ifdef KCONFIG_BENCHMARK_COUNTS_MALLOC
+    const quint64 allocations = s_mallocCount.load();
+#endif
+#ifdef KCONFIG_BENCHMARK_HAS_MALLINFO
+    const quint64 bytes = heapInUse();
+#endif
+    const auto sc = std::make_unique<KConfig>(shapeFile(shape), KConfig::SimpleConfig);
+#ifdef KCONFIG_BENCHMARK_COUNTS_MALLOC
+    usage.allocations = s_mallocCount.load() - allocations;
+#endif
+#ifdef KCONFIG_BENCHMARK_HAS_MALLINFO
+    usage.bytes = heapInUse() - bytes;
+#endif
+    KConfigIniBackendInternal::setSharedDataPoolEnabled(true);
+
+    usage.entries = entryCount(*sc);
+    return usage;
+}
+
+class BenchmarkSkeleton : public KCoreConfigSkeleton
+{
+public:
+    explicit BenchmarkSkeleton(const KSharedConfig::Ptr &config)
+        : KCoreConfigSkeleton(config)
+    {
+        setCurrentGroup(QStringLiteral("Group 0"));
+        for (int i = 0; i < int(std::size(m_ints)); ++i) {
+            addItemInt(QStringLiteral("Int%1").arg(i), m_ints[i], i, keyName(i));
+        }
+        setCurrentGroup(QStringLiteral("Group 1"));
+        for (int i = 0; i < int(std::size(m_strings)); ++i) {
+            addItemString(QStringLiteral("String%1").arg(i), m_strings[i], QStringLiteral("default"), keyName(i));
+        }
+        setCurrentGroup(QStringLiteral("Group 2"));
+        for (int i = 0; i < int(std::size(m_bools)); ++i) {
+            addItemBool(QStringLiteral("Bool%1").arg(i), m_bools[i], false, keyName(i));
+        }
+    }
+
+    qint32 m_ints[50];
+    QString m_strings[50];
+    bool m_bools[50];
+};
+} // namespace
+
 class KConfigBenchmark : public QObject
 {
     Q_OBJECT
@@ -26,7 +343,48 @@ private Q_SLOTS:
     void testParsing();
     void testHasKey();
     void testReadEntry();
+    void testReadEntryKeyHandle();
     void testKConfigGroupKeyList();
+
+    void testOpen_data();
+    void testOpen();
+    void testReparse_data();
+    void testReparse();
+    void testReparseTranslations_data();
+    void testReparseTranslations();
+    void testReparseAllocations_data();
+    void testReparseAllocations();
+    void testReparseMallocsPerEntry_data();
+    void testReparseMallocsPerEntry();
+    void testReparseBytesPerEntry_data();
+    void testReparseBytesPerEntry();
+    void testGroupList_data();
+    void testGroupList();
+    void testCascade_data();
+    void testCascade();
+
+    void testReadEntryTypes_data();
+    void testReadEntryTypes();
+    void testWriteEntry();
+    void testLongListEntry();
+    void testSync();
+    void testSyncAllocations();
+    void testSyncDurability_data();
+    void testSyncDurability();
+    void testDeleteGroup();
+
+    void testOpenSharedConfigHit();
+    void testOpenSharedConfigMiss();
+
+    void testSkeletonLoad();
+    void testSkeletonSave();
+
+    void testDesktopFileRead();
+    void testDesktopFileReadRecords();
+    void testDesktopFileIndexLookup();
+    void testTranslatedDesktopFileRead();
+
+    void testAuthorizeUrlAction();
 };
 
 void KConfigBenchmark::initTestCase()
@@ -38,6 +396,10 @@ void KConfigBenchmark::initTestCase()
     KConfigGroup cg(&sc, QStringLiteral("Main"));
     cg.deleteGroup();
     cg.writeEntry("UsedEntry", s_string_entry1);
+
+    for (Shape shape : {Shape::ManySmallGroups, Shape::FewHugeGroups, Shape::DeepNesting, Shape::Localized, Shape::Expansions}) {
+        QVERIFY(writeSyntheticConfig(shapeFile(shape), shape));
+    }
 }
 
 void KConfigBenchmark::testParsing()
@@ -108,6 +470,26 @@ void KConfigBenchmark::testReadEntry()
     QCOMPARE(notUsedEntry, defaultEntry);
 }
 
+void KConfigBenchmark::testReadEntryKeyHandle()
+{
+    QString usedEntry;
+    QString notUsedEntry;
+    const QString defaultEntry = QStringLiteral("Default");
+
+    KConfig sc(s_kconfig_test_subdir);
+    KConfigGroup cg(&sc, QStringLiteral("Main"));
+    const KConfigKey usedKey(cg, QStringLiteral("UsedEntry"));
+    const KConfigKey notUsedKey(cg, QStringLiteral("NotUsedEntry"));
+
+    QBENCHMARK {
+        usedEntry = usedKey.readEntry(defaultEntry);
+        notUsedEntry = notUsedKey.readEntry(defaultEntry);
+    }
+
+    QCOMPARE(usedEntry, s_string_entry1);
+    QCOMPARE(notUsedEntry, defaultEntry);
+}
+
 void KConfigBenchmark::testKConfigGroupKeyList()
 {
     QStringList keyList;
@@ -129,6 +511,490 @@ void KConfigBenchmark::testKConfigGroupKeyList()
     QCOMPARE(keyList, expectedKeyList);
 }
 
+void KConfigBenchmark::testOpen_data()
+{
+    addShapeRows();
+}
+
+void KConfigBenchmark::testOpen()
+{
+    QFETCH(Shape, shape);
+    const QString fileName = shapeFile(shape);
+
+    QBENCHMARK {
+        KConfig sc(fileName, KConfig::SimpleConfig);
+    }
+}
+
+void KConfigBenchmark::testReparse_data()
+{
+    addPoolRows();
+}
+
+void KConfigBenchmark::testReparse()
+{
+    QFETCH(Shape, shape);
+    QFETCH(bool, pool);
+    KConfigIniBackendInternal::setSharedDataPoolEnabled(pool);
+    KConfig sc(shapeFile(shape), KConfig::SimpleConfig);
+
+    QBENCHMARK {
+        sc.reparseConfiguration();
+    }
+    KConfigIniBackendInternal::setSharedDataPoolEnabled(true);
+}
+
+void KConfigBenchmark::testReparseTranslations_data()
+{
+    QTest::addColumn<bool>("reject");
+
+    QTest::newRow("rejected before parsing") << true;
+    QTest::newRow("parsed") << false;
+}
+
+// Reparsing a file with translations for dozens of locales, with and without dropping the
+// ones for other locales before their keys are parsed
+void KConfigBenchmark::testReparseTranslations()
+{
+    QFETCH(bool, reject);
+    KConfig sc(shapeFile(Shape::Localized), KConfig::SimpleConfig);
+    sc.setLocale(QStringLiteral("de_DE"));
+    KConfigIniBackendInternal::setForeignTranslationRejectEnabled(reject);
+
+    QBENCHMARK {
+        sc.reparseConfiguration();
+    }
+    KConfigIniBackendInternal::setForeignTranslationRejectEnabled(true);
+}
+
+void KConfigBenchmark::testReparseAllocations_data()
+{
+    addShapeRows();
+}
+
+void KConfigBenchmark::testReparseAllocations()
+{
+    QFETCH(Shape, shape);
+    KConfig sc(shapeFile(shape), KConfig::SimpleConfig);
+
+    const quint64 before = s_allocationCount.load();
+    sc.reparseConfiguration();
+    QTest::setBenchmarkResult(s_allocationCount.load() - before, QTest::Events);
+}
+
+void KConfigBenchmark::testReparseMallocsPerEntry_data()
+{
+    addPoolRows();
+}
+
+void KConfigBenchmark::testReparseMallocsPerEntry()
+{
+#ifdef KCONFIG_BENCHMARK_COUNTS_MALLOC
+    QFETCH(Shape, shape);
+    QFETCH(bool, pool);
+    const HeapUsage usage = parseHeapUsage(shape, pool);
+    QVERIFY(usage.entries > 0);
+    QTest::setBenchmarkResult(qreal(usage.allocations) / usage.entries, QTest::Events);
+#else
+    QSKIP("Counting malloc() needs glibc and the CMake option KCONFIG_BENCHMARK_COUNT_MALLOC");
+#endif
+}
+
+void KConfigBenchmark::testReparseBytesPerEntry_data()
+{
+    addPoolRows();
+}
+
+void KConfigBenchmark::testReparseBytesPerEntry()
+{
+#ifdef KCONFIG_BENCHMARK_HAS_MALLINFO
+    QFETCH(Shape, shape);
+    QFETCH(bool, pool);
+    const HeapUsage usage = parseHeapUsage(shape, pool);
+    QVERIFY(usage.entries > 0);
+    QTest::setBenchmarkResult(qreal(usage.bytes) / usage.entries, QTest::BytesAllocated);
+#else
+    QSKIP("Measuring the heap in use needs glibc 2.33 or later");
+#endif
+}
+
+void KConfigBenchmark::testGroupList_data()
+{
+    addShapeRows();
+}
+
+void KConfigBenchmark::testGroupList()
+{
+    QFETCH(Shape, shape);
+    KConfig sc(shapeFile(shape), KConfig::SimpleConfig);
+
+    QStringList groups;
+    QBENCHMARK {
+        groups = sc.groupList();
+    }
+    QVERIFY(!groups.isEmpty());
+}
+
+void KConfigBenchmark::testCascade_data()
+{
+    QTest::addColumn<int>("files");
+
+    QTest::newRow("1 file") << 1;
+    QTest::newRow("4 files") << 4;
+    QTest::newRow("16 files") << 16;
+}
+
+void KConfigBenchmark::testCascade()
+{
+    QFETCH(int, files);
+
+    QStringList sources;
+    for (int i = 0; i < files; ++i) {
+        const QString path = syntheticConfigPath(QStringLiteral("cascade/source%1rc").arg(i));
+        QVERIFY(writeSyntheticConfig(path, Shape::ManySmallGroups));
+        sources << path;
+    }
+    const QString mainFile = sources.takeLast();
+
+    QBENCHMARK {
+        KConfig cascade(mainFile, KConfig::CascadeConfig);
+        cascade.addConfigSources(sources);
+    }
+}
+
+void KConfigBenchmark::testReadEntryTypes_data()
+{
+    QTest::addColumn<QString>("type");
+
+    QTest::newRow("QString") << QStringLiteral("QString");
+    QTest::newRow("int") << QStringLiteral("int");
+    QTest::newRow("bool") << QStringLiteral("bool");
+    QTest::newRow("double") << QStringLiteral("double");
+    QTest::newRow("QStringList") << QStringLiteral("QStringList");
+    QTest::newRow("QList<int>") << QStringLiteral("QList<int>");
+    QTest::newRow("QByteArray") << QStringLiteral("QByteArray");
+}
+
+void KConfigBenchmark::testReadEntryTypes()
+{
+    QFETCH(QString, type);
+
+    KConfig sc(syntheticConfigPath(QStringLiteral("benchmark_typesrc")), KConfig::SimpleConfig);
+    KConfigGroup cg(&sc, QStringLiteral("Types"));
+    cg.writeEntry("QString", s_string_entry1);
+    cg.writeEntry("int", 42);
+    cg.writeEntry("bool", true);
+    cg.writeEntry("double", 3.1415);
+    cg.writeEntry("QStringList", QStringList{QStringLiteral("one"), QStringLiteral("two,three"), QStringLiteral("four")});
+    cg.writeEntry("QList<int>", QList<int>{1, 2, 3, 4, 5, 6, 7, 8});
+    cg.writeEntry("QByteArray", QByteArray("some bytes"));
+
+    const QByteArray key = type.toUtf8();
+    if (type == QLatin1String("QString")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), QString());
+        }
+    } else if (type == QLatin1String("int")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), 0);
+        }
+    } else if (type == QLatin1String("bool")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), false);
+        }
+    } else if (type == QLatin1String("double")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), 0.0);
+        }
+    } else if (type == QLatin1String("QStringList")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), QStringList());
+        }
+    } else if (type == QLatin1String("QList<int>")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), QList<int>());
+        }
+    } else if (type == QLatin1String("QByteArray")) {
+        QBENCHMARK {
+            cg.readEntry(key.constData(), QByteArray());
+        }
+    }
+}
+
+void KConfigBenchmark::testWriteEntry()
+{
+    KConfig sc(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&sc, QStringLiteral("Main"));
+
+    int i = 0;
+    QBENCHMARK {
+        cg.writeEntry("Entry", ++i);
+    }
+}
+
+void KConfigBenchmark::testLongListEntry()
+{
+    // the size of a long recent files list or history
+    QStringList list;
+    for (int i = 0; i < 5000; ++i) {
+        list.append(QStringLiteral("/home/user/Documents/report, part %1.odt").arg(i));
+    }
+
+    KConfig sc(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&sc, QStringLiteral("Recent Files"));
+
+    QBENCHMARK {
+        cg.writeEntry("Files", list);
+        cg.readEntry("Files", QStringList());
+    }
+}
+
+void KConfigBenchmark::testSync()
+{
+    KConfig sc(shapeFile(Shape::ManySmallGroups), KConfig::SimpleConfig);
+    KConfigGroup cg(&sc, QStringLiteral("Group 0"));
+
+    int i = 0;
+    QBENCHMARK {
+        cg.writeEntry("Counter", ++i);
+        QVERIFY(sc.sync());
+    }
+}
+
+void KConfigBenchmark::testSyncAllocations()
+{
+    KConfig sc(shapeFile(Shape::ManySmallGroups), KConfig::SimpleConfig);
+    KConfigGroup cg(&sc, QStringLiteral("Group 0"));
+    cg.writeEntry("Counter", 0);
+    QVERIFY(sc.sync());
+
+    cg.writeEntry("Counter", 1);
+    const quint64 before = s_allocationCount.load();
+    QVERIFY(sc.sync());
+    QTest::setBenchmarkResult(s_allocationCount.load() - before, QTest::Events);
+}
+
+void KConfigBenchmark::testSyncDurability_data()
+{
+    QTest::addColumn<KConfig::Durability>("durability");
+
+    QTest::newRow("full") << KConfig::FullDurability;
+    QTest::newRow("rename") << KConfig::RenameDurability;
+    QTest::newRow("deferred") << KConfig::DeferredDurability;
+}
+
+void KConfigBenchmark::testSyncDurability()
+{
+    QFETCH(KConfig::Durability, durability);
+    KConfig sc(shapeFile(Shape::ManySmallGroups), KConfig::SimpleConfig);
+    sc.setDurability(durability);
+    KConfigGroup cg(&sc, QStringLiteral("Group 0"));
+
+    int i = 0;
+    QBENCHMARK {
+        cg.writeEntry("Counter", ++i);
+        QVERIFY(sc.sync());
+    }
+}
+
+void KConfigBenchmark::testDeleteGroup()
+{
+    KConfig sc(shapeFile(Shape::DeepNesting), KConfig::SimpleConfig);
+
+    QBENCHMARK {
+        // delete into a fresh in-memory copy so every iteration does the same work
+        KConfig copy(QString(), KConfig::SimpleConfig);
+        copy.copyFrom(sc);
+        copy.deleteGroup(QStringLiteral("Containments"));
+        copy.markAsClean();
+    }
+}
+
+void KConfigBenchmark::testOpenSharedConfigHit()
+{
+    KSharedConfig::Ptr keepAlive = KSharedConfig::openConfig(s_kconfig_test_subdir, KConfig::SimpleConfig);
+
+    QBENCHMARK {
+        KSharedConfig::Ptr config = KSharedConfig::openConfig(s_kconfig_test_subdir, KConfig::SimpleConfig);
+    }
+}
+
+void KConfigBenchmark::testOpenSharedConfigMiss()
+{
+    QBENCHMARK {
+        KSharedConfig::Ptr config = KSharedConfig::openConfig(s_kconfig_test_subdir, KConfig::SimpleConfig);
+    }
+}
+
+void KConfigBenchmark::testSkeletonLoad()
+{
+    BenchmarkSkeleton skeleton(KSharedConfig::openConfig(shapeFile(Shape::ManySmallGroups), KConfig::SimpleConfig));
+
+    QBENCHMARK {
+        skeleton.load();
+    }
+    QCOMPARE(skeleton.m_ints[0], 0);
+}
+
+void KConfigBenchmark::testSkeletonSave()
+{
+    BenchmarkSkeleton skeleton(KSharedConfig::openConfig(syntheticConfigPath(QStringLiteral("benchmark_skeletonrc")), KConfig::SimpleConfig));
+
+    int i = 0;
+    QBENCHMARK {
+        skeleton.m_ints[0] = ++i;
+        QVERIFY(skeleton.save());
+    }
+}
+
+void KConfigBenchmark::testDesktopFileRead()
+{
+    const QString fileName = syntheticConfigPath(QStringLiteral("benchmark.desktop"));
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+        file.write(
+            "[Desktop Entry]\n"
+            "Type=Application\n"
+            "Name=Benchmark\n"
+            "Name[de]=Leistungstest\n"
+            "Name[fr]=Banc d'essai\n"
+            "Comment=Benchmarks desktop file reading\n"
+            "Icon=benchmark\n"
+            "Exec=benchmark %u\n"
+            "MimeType=text/plain;text/html;\n"
+            "Actions=New;Open;\n"
+            "\n"
+            "[Desktop Action New]\n"
+            "Name=New Window\n"
+            "Exec=benchmark --new\n"
+            "\n"
+            "[Desktop Action Open]\n"
+            "Name=Open File\n"
+            "Exec=benchmark --open\n");
+    }
+
+    QString name;
+    QBENCHMARK {
+        KDesktopFile desktopFile(fileName);
+        name = desktopFile.readName();
+        desktopFile.readIcon();
+        desktopFile.readMimeTypes();
+        desktopFile.readActions();
+        desktopFile.noDisplay();
+    }
+    QCOMPARE(name, QStringLiteral("Benchmark"));
+}
+
+void KConfigBenchmark::testTranslatedDesktopFileRead()
+{
+    // Shaped like the .desktop files of applications translated by KDE's localization teams,
+    // which carry some 90 translations for each of their translatable keys
+    static const char *const locales[] = {
+        "af", "ar", "as", "ast", "az", "be", "be@latin", "bg", "bn", "bn_IN", "br", "bs", "ca", "ca@valencia", "cs", "csb", "cy", "da", "de", "el", "en_GB",
+        "eo", "es", "et", "eu", "fa", "fi", "fr", "fy", "ga", "gd", "gl", "gu", "he", "hi", "hne", "hr", "hsb", "hu", "hy", "ia", "id", "is", "it", "ja", "ka",
+        "kk", "km", "kn", "ko", "ku", "lt", "lv", "mai", "mk", "ml", "mr", "ms", "nb", "nds", "ne", "nl", "nn", "oc", "or", "pa", "pl", "pt", "pt_BR", "ro",
+        "ru", "se", "si", "sk", "sl", "sq", "sr", "sr@ijekavian", "sv", "ta", "te", "tg", "th", "tr", "ug", "uk", "uz", "vi", "wa", "zh_CN", "zh_TW",
+    };
+    static const char *const translatedKeys[] = {"Name", "GenericName", "Comment", "Keywords"};
+
+    const QString fileName = syntheticConfigPath(QStringLiteral("benchmark_translated.desktop"));
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+        QTextStream out(&file);
+        out << "[Desktop Entry]\nType=Application\nExec=benchmark %U\nIcon=benchmark\n";
+        for (const char *key : translatedKeys) {
+            out << key << "=Untranslated " << key << '\n';
+            for (const char *locale : locales) {
+                out << key << '[' << locale << "]=Translated " << key << " for " << locale << '\n';
+            }
+        }
+        out << "MimeType=text/plain;\nCategories=Qt;KDE;Utility;\n";
+    }
+
+    QString name;
+    QBENCHMARK {
+        KDesktopFile desktopFile(fileName);
+        name = desktopFile.readName();
+        desktopFile.readComment();
+        desktopFile.readGenericName();
+    }
+    QVERIFY(name.startsWith(QLatin1String("Untranslated")) || name.startsWith(QLatin1String("Translated")));
+}
+
+void KConfigBenchmark::testDesktopFileReadRecords()
+{
+    // testDesktopFileRead() wrote the file, read it as often as a menu reads different ones
+    const QStringList paths(200, syntheticConfigPath(QStringLiteral("benchmark.desktop")));
+    const QStringList keys{QStringLiteral("Type"), QStringLiteral("Name"), QStringLiteral("Icon"), QStringLiteral("MimeType"), QStringLiteral("NoDisplay")};
+
+    QList<KDesktopFileRecord> records;
+    QBENCHMARK {
+        records = KDesktopFile::readRecords(paths, keys);
+    }
+    QCOMPARE(records.size(), paths.size());
+    QCOMPARE(records.constFirst().value(QStringLiteral("Name")), QStringLiteral("Benchmark"));
+}
+
+void KConfigBenchmark::testDesktopFileIndexLookup()
+{
+    // the same entries as a menu reads with KDesktopFile, answered from the index
+    KDesktopFileIndex index(QStringList{syntheticConfigPath(QString())});
+    index.update();
+    const QString id = QStringLiteral("benchmark.desktop");
+    QVERIFY(index.contains(id));
+
+    QString name;
+    QBENCHMARK {
+        name = index.readName(id);
+        index.readIcon(id);
+        index.noDisplay(id);
+        index.readMimeTypes(id);
+    }
+    QCOMPARE(name, QStringLiteral("Benchmark"));
+}
+
+void KConfigBenchmark::testAuthorizeUrlAction()
+{
+    // 1000 rules spread over a few actions, protocols and path prefixes, like a locked down kiosk setup
+    constexpr int ruleCount = 1000;
+    const QString actions[] = {QStringLiteral("list"), QStringLiteral("open"), QStringLiteral("redirect"), QStringLiteral("link")};
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg = config.group(QStringLiteral("KDE URL Restrictions"));
+    cg.writeEntry("rule_count", ruleCount);
+    for (int i = 1; i <= ruleCount; ++i) {
+        cg.writeEntry(QStringLiteral("rule_%1").arg(i),
+                      QStringList{actions[i % std::size(actions)],
+                                  {},
+                                  {},
+                                  {},
+                                  QStringLiteral("proto%1").arg(i % 50),
+                                  {},
+                                  QStringLiteral("/data/dir%1").arg(i),
+                                  (i % 3) ? QStringLiteral("true") : QStringLiteral("false")});
+    }
+    loadUrlActionRestrictions(cg);
+
+    const QUrl base(QStringLiteral("file:///home/user"));
+    const QUrl urls[] = {
+        QUrl(QStringLiteral("proto7:///data/dir7/file")),
+        QUrl(QStringLiteral("proto42:///data/dir992/sub/file")),
+        QUrl(QStringLiteral("file:///home/user/Documents")),
+        QUrl(QStringLiteral("https://kde.org/index.html")),
+    };
+    const QString localClass(QStringLiteral(":local"));
+
+    // one iteration is 1000 checks
+    QBENCHMARK {
+        for (int i = 0; i < 250; ++i) {
+            for (const QUrl &url : urls) {
+                KAuthorizedInternal::authorizeUrlAction(actions[i % std::size(actions)], base, url, localClass, QString());
+            }
+        }
+    }
+}
+
 QTEST_GUILESS_MAIN(KConfigBenchmark)
 
 #include "kconfig_benchmark.moc"
@@ -0,0 +1,100 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <KConfigLoader>
+#include <KConfigSkeleton>
+#include <KSharedConfig>
+#include <KStandardShortcut>
+
+#include <QBuffer>
+#include <QFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+class KConfigGuiBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testConfigLoaderConstruction_data();
+    void testConfigLoaderConstruction();
+    void testConfigLoaderLoadSave();
+
+    void testStandardShortcutFind();
+    void testStandardShortcutFindByName();
+};
+
+void KConfigGuiBenchmark::initTestCase()
+{
+    // ensure we don't use files in the real config directory
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void KConfigGuiBenchmark::testConfigLoaderConstruction_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    // warm: the schema was parsed before in this process
+    QTest::newRow("warm") << true;
+    // cold: every loader gets XML not seen before, like the first loader of a process
+    QTest::newRow("cold") << false;
+}
+
+void KConfigGuiBenchmark::testConfigLoaderConstruction()
+{
+    QFETCH(bool, cached);
+    QFile xmlFile(QFINDTESTDATA("kconfigloadertest.xml"));
+    QVERIFY(xmlFile.open(QIODevice::ReadOnly));
+    const QByteArray xml = xmlFile.readAll();
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QStringLiteral("kconfiggui_benchmarkrc"), KConfig::SimpleConfig);
+
+    int iteration = 0;
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.setData(cached ? xml : xml + "<!-- " + QByteArray::number(++iteration) + " -->\n");
+        KConfigLoader loader(config, &buffer);
+    }
+}
+
+void KConfigGuiBenchmark::testConfigLoaderLoadSave()
+{
+    QFile xmlFile(QFINDTESTDATA("kconfigloadertest.xml"));
+    KConfigLoader loader(KSharedConfig::openConfig(QStringLiteral("kconfiggui_benchmarkrc"), KConfig::SimpleConfig), &xmlFile);
+
+    QBENCHMARK {
+        loader.load();
+        QVERIFY(loader.save());
+    }
+}
+
+void KConfigGuiBenchmark::testStandardShortcutFind()
+{
+    const QKeySequence unused(Qt::CTRL | Qt::ALT | Qt::SHIFT | Qt::Key_F12);
+    const QKeySequence copy(QKeySequence::Copy);
+
+    KStandardShortcut::StandardShortcut found = KStandardShortcut::AccelNone;
+    QBENCHMARK {
+        found = KStandardShortcut::find(copy);
+        KStandardShortcut::find(unused);
+    }
+    QCOMPARE(found, KStandardShortcut::Copy);
+}
+
+void KConfigGuiBenchmark::testStandardShortcutFindByName()
+{
+    KStandardShortcut::StandardShortcut found = KStandardShortcut::AccelNone;
+    QBENCHMARK {
+        found = KStandardShortcut::findByName(QStringLiteral("Paste"));
+    }
+    QCOMPARE(found, KStandardShortcut::Paste);
+}
+
+QTEST_MAIN(KConfigGuiBenchmark)
+
+#include "kconfiggui_benchmark.moc"
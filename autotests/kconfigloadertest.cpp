@@ -5,6 +5,8 @@
 */
 #include "kconfigloadertest.h"
 
+#include <QBuffer>
+
 #include <kconfig.h>
 #include <kconfiggroup.h>
 #include <kconfigloader.h>
@@ -258,6 +260,29 @@ void ConfigLoaderTest::testConfigGroup()
     delete loader;
 }
 
+void ConfigLoaderTest::testSharedSchema()
+{
+    // a second loader from the same XML reuses the parsed schema, but has items of its own
+    QFile xmlFile(QFINDTESTDATA(QString::fromLatin1("/") + s_testName + QLatin1String(".xml")));
+    QVERIFY(xmlFile.open(QIODevice::ReadOnly));
+    QBuffer buffer;
+    buffer.setData(xmlFile.readAll());
+
+    KConfigLoader other(QStringLiteral("kconfigloadertestshared"), &buffer);
+    QCOMPARE(other.items().size(), cl->items().size());
+    QCOMPARE(other.groupList(), cl->groupList());
+    QCOMPARE(other.currentGroup(), cl->currentGroup());
+
+    auto item = static_cast<KConfigSkeleton::ItemInt *>(other.findItem(s_testName, QStringLiteral("DefaultIntItem")));
+    QVERIFY(item);
+    item->setValue(42);
+    QCOMPARE(static_cast<KConfigSkeleton::ItemInt *>(cl->findItem(s_testName, QStringLiteral("DefaultIntItem")))->value(), 27);
+
+    const auto enumItem = dynamic_cast<KConfigSkeleton::ItemEnum *>(other.findItemByName(QStringLiteral("DefaultEnumItem")));
+    QVERIFY(enumItem);
+    QCOMPARE(enumItem->choices().size(), 4);
+}
+
 QTEST_MAIN(ConfigLoaderTest)
 
 #include "moc_kconfigloadertest.cpp"
@@ -48,6 +48,7 @@ private Q_SLOTS:
     void ulongLongDefaultValue();
     void timeDefaultValue();
     void testConfigGroup();
+    void testSharedSchema();
 
 private:
     KConfigLoader *cl;
@@ -0,0 +1,139 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KConfigGroup>
+#include <KConfigPropertyMap>
+#include <KConfigTracing>
+#include <KCoreConfigSkeleton>
+#include <KSharedConfig>
+
+class Settings : public KCoreConfigSkeleton
+{
+public:
+    explicit Settings(const QString &fileName)
+        : KCoreConfigSkeleton(KSharedConfig::openConfig(fileName, KConfig::SimpleConfig))
+    {
+        setCurrentGroup(QStringLiteral("General"));
+        addItemInt(QStringLiteral("Size"), size, 10);
+        addItemString(QStringLiteral("Name"), name, QStringLiteral("default"));
+        read();
+    }
+
+    qint32 size = 0;
+    QString name;
+};
+
+class KConfigPropertyMapTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        KConfigTracing::setEnabled(true);
+    }
+
+    void init()
+    {
+        QVERIFY(m_dir.isValid());
+        m_fileName = m_dir.filePath(QStringLiteral("propertymaptestrc"));
+        QFile::remove(m_fileName);
+        KConfigTracing::reset();
+    }
+
+    void testReloadOnlyChangedValues()
+    {
+        Settings settings(m_fileName);
+        KConfigPropertyMap map(&settings);
+        QCOMPARE(map.value(QStringLiteral("Size")).toInt(), 10);
+        QCOMPARE(map.value(QStringLiteral("SizeDefault")).toInt(), 10);
+        QCOMPARE(map.value(QStringLiteral("Name")).toString(), QStringLiteral("default"));
+
+        QSignalSpy spy(&map, &QQmlPropertyMap::valueChanged);
+        KConfig other(m_fileName, KConfig::SimpleConfig);
+        other.group(QStringLiteral("General")).writeEntry("Size", 20);
+        QVERIFY(other.sync());
+        settings.load();
+        Q_EMIT settings.configChanged();
+
+        // only the value that changed is reported, and nothing is written back
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(0).toString(), QStringLiteral("Size"));
+        QCOMPARE(map.value(QStringLiteral("Size")).toInt(), 20);
+        QVERIFY(!settings.isSaveNeeded());
+        QVERIFY(!settings.config()->isDirty());
+    }
+
+    void testWriteOnlyChangedValues()
+    {
+        Settings settings(m_fileName);
+        KConfigPropertyMap map(&settings);
+
+        // nothing differs from the config, so the file isn't written
+        map.writeConfig();
+        QVERIFY(!QFile::exists(m_fileName));
+        QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(0));
+
+        map.insert(QStringLiteral("Name"), QStringLiteral("changed"));
+        map.writeConfig();
+        QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(1));
+        QCOMPARE(settings.name, QStringLiteral("changed"));
+
+        KConfig written(m_fileName, KConfig::SimpleConfig);
+        const KConfigGroup group = written.group(QStringLiteral("General"));
+        QCOMPARE(group.readEntry("Name"), QStringLiteral("changed"));
+        QVERIFY(!group.hasKey("Size"));
+
+        map.writeConfig();
+        QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(1));
+
+        // entries written to the KConfig of the skeleton directly are synced as well
+        settings.config()->group(QStringLiteral("Other")).writeEntry("Direct", 1);
+        map.writeConfig();
+        QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(2));
+        QVERIFY(!settings.config()->isDirty());
+    }
+
+    void testAutoSave()
+    {
+        Settings settings(m_fileName);
+        {
+            KConfigPropertyMap map(&settings);
+            map.setAutoSaveDelay(50);
+            QCOMPARE(map.autoSaveDelay(), 50);
+
+            // changes in quick succession, as made from QML, are saved together
+            for (int size = 1; size <= 3; ++size) {
+                QVERIFY(map.setProperty("Size", size));
+            }
+            QCOMPARE(settings.size, 3);
+            QVERIFY(!QFile::exists(m_fileName));
+            QTRY_VERIFY(QFile::exists(m_fileName));
+            QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(1));
+            QCOMPARE(KConfig(m_fileName, KConfig::SimpleConfig).group(QStringLiteral("General")).readEntry("Size", 0), 3);
+
+            // a change still waiting for the timer is saved when the map goes away
+            map.setAutoSaveDelay(60000);
+            QVERIFY(map.setProperty("Size", 4));
+        }
+        QCOMPARE(KConfigTracing::statistics().value(m_fileName).writeCount, quint64(2));
+        QCOMPARE(KConfig(m_fileName, KConfig::SimpleConfig).group(QStringLiteral("General")).readEntry("Size", 0), 4);
+    }
+
+private:
+    QTemporaryDir m_dir;
+    QString m_fileName;
+};
+
+QTEST_GUILESS_MAIN(KConfigPropertyMapTest)
+
+#include "kconfigpropertymaptest.moc"
@@ -32,6 +32,12 @@
 
 using namespace Qt::StringLiterals;
 
+// Exported from kconfigini.cpp for the benchmark and this test
+namespace KConfigIniBackendInternal
+{
+KCONFIGCORE_EXPORT void setForeignTranslationRejectEnabled(bool enabled);
+}
+
 KCONFIGGROUP_DECLARE_ENUM_QOBJECT(KConfigTest, Testing)
 KCONFIGGROUP_DECLARE_FLAGS_QOBJECT(KConfigTest, Flags)
 
@@ -2171,6 +2177,244 @@ void KConfigTest::testXdgListEntry()
     QCOMPARE(grp.readXdgListEntry("Key6", invalidList), (QStringList{QStringLiteral("1"), QStringLiteral("2;3"), QString{}}));
 }
 
+void KConfigTest::testListRoundTrip()
+{
+    QStringList escaped{QStringLiteral("a,b"), QStringLiteral("c;d"), QStringLiteral("\\"), QString(), QStringLiteral("e\\,f\\;"), QString()};
+    QStringList longList;
+    for (int i = 0; i < 5000; ++i) {
+        longList.append(QStringLiteral("/home/user/Documents/file%1.txt").arg(i));
+    }
+    QStringList longEscapedList = longList;
+    longEscapedList[2500] = QStringLiteral("comma,in\\the middle");
+
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup grp = config.group(QStringLiteral("Lists"));
+    for (const QStringList &list : {escaped, longList, longEscapedList, QStringList{QString()}, QStringList{QStringLiteral("single")}}) {
+        grp.writeEntry("list", list);
+        QCOMPARE(grp.readEntry("list", QStringList{}), list);
+        grp.writeXdgListEntry("xdgList", list);
+        QCOMPARE(grp.readXdgListEntry("xdgList"), list);
+    }
+
+    grp.writeEntry("list", escaped);
+    QCOMPARE(grp.readEntry("list"), QStringLiteral("a\\,b,c;d,\\\\,,e\\\\\\,f\\\\;,"));
+    grp.writeXdgListEntry("xdgList", escaped);
+    QCOMPARE(grp.readEntry("xdgList"), QStringLiteral("a,b;c\\;d;\\\\;;e\\\\,f\\\\\\;;;"));
+}
+
+void KConfigTest::testKeyHandle()
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup grp = config.group(QStringLiteral("Handles"));
+    KConfigGroup subGroup = grp.group(QStringLiteral("Sub"));
+
+    const KConfigKey stringKey(grp, QStringLiteral("string"));
+    const KConfigKey listKey(grp, "list");
+    const KConfigKey intKey(subGroup, "int");
+    QVERIFY(stringKey.isValid());
+    QVERIFY(!KConfigKey().isValid());
+    QCOMPARE(stringKey.key(), QByteArray("string"));
+    QCOMPARE(intKey.group().name(), QStringLiteral("Sub"));
+
+    QVERIFY(!stringKey.exists());
+    QCOMPARE(stringKey.readEntry(QStringLiteral("default")), QStringLiteral("default"));
+    QCOMPARE(intKey.readEntry(7), 7);
+
+    grp.writeEntry("string", QStringLiteral("first"));
+    grp.writeEntry("list", QStringList{QStringLiteral("a"), QStringLiteral("b,c")});
+    subGroup.writeEntry("int", 42);
+    QVERIFY(stringKey.exists());
+    QCOMPARE(stringKey.readEntry(QString()), QStringLiteral("first"));
+    QCOMPARE(stringKey.readEntry(), QStringLiteral("first"));
+    QCOMPARE(listKey.readEntry(QStringList()), (QStringList{QStringLiteral("a"), QStringLiteral("b,c")}));
+    QCOMPARE(listKey.readEntry(QVariantList()), (QVariantList{QStringLiteral("a"), QStringLiteral("b,c")}));
+    QCOMPARE(intKey.readEntry(7), 42);
+    QCOMPARE(intKey.readEntry(QList<int>()), QList<int>{42});
+
+    // the handles notice writes, also through other groups or keys
+    config.group(QStringLiteral("Handles")).writeEntry(QStringLiteral("string"), QStringLiteral("second"));
+    QCOMPARE(stringKey.readEntry(QString()), QStringLiteral("second"));
+    grp.writeXdgListEntry("list", QStringList{QStringLiteral("x"), QStringLiteral("y;z")});
+    QCOMPARE(listKey.readXdgListEntry(), (QStringList{QStringLiteral("x"), QStringLiteral("y;z")}));
+    grp.deleteEntry("string");
+    QVERIFY(!stringKey.exists());
+    QCOMPARE(stringKey.readEntry(QStringLiteral("default")), QStringLiteral("default"));
+    grp.deleteGroup(QStringLiteral("Sub"));
+    QCOMPARE(intKey.readEntry(7), 7);
+
+    // entries marked with [$e] are expanded like the group does
+    qputenv("KCONFIGTEST_HANDLE", "/expanded");
+    grp.writePathEntry("path", QStringLiteral("$KCONFIGTEST_HANDLE/file"));
+    const KConfigKey pathKey(grp, "path");
+    QCOMPARE(pathKey.readPathEntry(QString()), grp.readPathEntry("path", QString()));
+    QCOMPARE(pathKey.readEntry(QString()), grp.readEntry("path", QString()));
+    QCOMPARE(pathKey.readEntry(QString()), QStringLiteral("/expanded/file"));
+
+    // and copies into the group from another config
+    KConfig other(QString(), KConfig::SimpleConfig);
+    KConfigGroup otherGroup = other.group(QStringLiteral("Handles"));
+    otherGroup.writeEntry("string", QStringLiteral("copied"));
+    otherGroup.writeEntry("list", QStringList{QStringLiteral("c"), QStringLiteral("d")});
+    QCOMPARE(stringKey.readEntry(QStringLiteral("default")), QStringLiteral("default"));
+    QCOMPARE(listKey.readXdgListEntry(), (QStringList{QStringLiteral("x"), QStringLiteral("y;z")}));
+    otherGroup.copyTo(&grp);
+    QCOMPARE(stringKey.readEntry(QStringLiteral("default")), QStringLiteral("copied"));
+    QCOMPARE(listKey.readEntry(QStringList()), (QStringList{QStringLiteral("c"), QStringLiteral("d")}));
+}
+
+void KConfigTest::testSharedEntryData()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QTextStream out(&file);
+    out << "[Plugin A]\n"
+        << "Enabled=true\n"
+        << "Position=left\n"
+        << "Empty=\n"
+        << "[Plugin B]\n"
+        << "Enabled=true\n"
+        << "Position=left\n"
+        << "Empty=\n"
+        << "Other=left\n";
+    out.flush();
+    file.close();
+
+    KConfig config(file.fileName(), KConfig::SimpleConfig);
+    const KConfigGroup a = config.group(QStringLiteral("Plugin A"));
+    const KConfigGroup b = config.group(QStringLiteral("Plugin B"));
+
+    // equal short values read from a file share their data
+    const QByteArray enabledA = a.readEntry("Enabled", QByteArray());
+    const QByteArray enabledB = b.readEntry("Enabled", QByteArray());
+    QCOMPARE(enabledA, QByteArray("true"));
+    QCOMPARE(enabledA.constData(), enabledB.constData());
+    const QByteArray positionA = a.readEntry("Position", QByteArray());
+    QCOMPARE(positionA, QByteArray("left"));
+    QCOMPARE(positionA.constData(), b.readEntry("Position", QByteArray()).constData());
+    QCOMPARE(positionA.constData(), b.readEntry("Other", QByteArray()).constData());
+
+    // empty values stay empty and not deleted
+    QVERIFY(b.hasKey("Empty"));
+    QCOMPARE(b.readEntry("Empty", QStringLiteral("default")), QString());
+    QCOMPARE(b.keyList(), (QStringList{QStringLiteral("Empty"), QStringLiteral("Enabled"), QStringLiteral("Other"), QStringLiteral("Position")}));
+}
+
+void KConfigTest::testForeignTranslations()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("translationsrc"));
+    QVERIFY(writeTextFile(path,
+                          "[Group]\n"_L1
+                          "Name=Default\n"_L1
+                          "Name[de]=Deutsch\n"_L1
+                          "Name[fr]=Francais\n"_L1
+                          "Name[fr_CA]=Quebec\n"_L1
+                          "Name[pt_BR]=Brasil\n"_L1
+                          "Name[C]=C value\n"_L1
+                          "Comment=Default comment\n"_L1
+                          "Comment[fr]=Commentaire\n"_L1
+                          "Comment[de_AT]=Servus\n"_L1
+                          "Comment[ de ] =Spaced\n"_L1
+                          "Path[$e]=$HOME/translated\n"_L1
+                          "Fixed[$i]=fixed\n"_L1
+                          "Odd[fr]x=odd\n"_L1
+                          "Empty[]=empty\n"_L1
+                          "Two[de][fr]=two\n"_L1));
+
+    const QStringList locales{QStringLiteral("fr_CA"), QStringLiteral("fr_FR"), QStringLiteral("de_AT"), QStringLiteral("en_US"), QStringLiteral("pt")};
+    for (const QString &locale : locales) {
+        // dropping translations for other locales before parsing them changes nothing
+        KConfigIniBackendInternal::setForeignTranslationRejectEnabled(false);
+        KConfig fullyParsed(path, KConfig::SimpleConfig);
+        fullyParsed.setLocale(locale);
+        KConfigIniBackendInternal::setForeignTranslationRejectEnabled(true);
+        KConfig config(path, KConfig::SimpleConfig);
+        config.setLocale(locale);
+        const KConfigGroup group = config.group(QStringLiteral("Group"));
+        QCOMPARE(group.entryMap(), fullyParsed.group(QStringLiteral("Group")).entryMap());
+        QCOMPARE(group.isEntryImmutable("Fixed"), fullyParsed.group(QStringLiteral("Group")).isEntryImmutable("Fixed"));
+        QVERIFY(group.isEntryImmutable("Fixed"));
+        QCOMPARE(group.readEntry("Path"), homePath() + QLatin1String("/translated"));
+        QCOMPARE(group.readEntry("Empty"), QStringLiteral("empty"));
+        QVERIFY(!group.hasKey("Two"));
+    }
+
+    KConfig config(path, KConfig::SimpleConfig);
+    KConfigGroup group = config.group(QStringLiteral("Group"));
+    // the current locale wins over its language
+    config.setLocale(QStringLiteral("fr_CA"));
+    QCOMPARE(group.readEntry("Name"), QStringLiteral("Quebec"));
+    QCOMPARE(group.readEntry("Comment"), QStringLiteral("Commentaire"));
+    QCOMPARE(group.readEntry("Odd"), QStringLiteral("odd"));
+    // the language alone is used without a translation for the locale
+    config.setLocale(QStringLiteral("fr_FR"));
+    QCOMPARE(group.readEntry("Name"), QStringLiteral("Francais"));
+    config.setLocale(QStringLiteral("de_AT"));
+    QCOMPARE(group.readEntry("Name"), QStringLiteral("Deutsch"));
+    QCOMPARE(group.readEntry("Comment"), QStringLiteral("Servus"));
+    QVERIFY(!group.hasKey("Odd"));
+    // C is taken for en_US
+    config.setLocale(QStringLiteral("en_US"));
+    QCOMPARE(group.readEntry("Name"), QStringLiteral("C value"));
+    config.setLocale(QStringLiteral("pt"));
+    QCOMPARE(group.readEntry("Name"), QStringLiteral("Default"));
+    QCOMPARE(group.readEntry("Comment"), QStringLiteral("Default comment"));
+
+    // writing the file back keeps the translations for all other locales
+    config.setLocale(QStringLiteral("fr_CA"));
+    group.writeEntry("New", 1);
+    QVERIFY(config.sync());
+    const QByteArray written = readLinesFrom(path).join();
+    for (const char *line :
+         {"Name[de]=Deutsch\n", "Name[fr]=Francais\n", "Name[pt_BR]=Brasil\n", "Name[C]=C value\n", "Comment[de_AT]=Servus\n", "New=1\n"}) {
+        QVERIFY2(written.contains(line), line);
+    }
+}
+
+void KConfigTest::testDurability_data()
+{
+    QTest::addColumn<KConfig::Durability>("durability");
+
+    QTest::newRow("full") << KConfig::FullDurability;
+    QTest::newRow("rename") << KConfig::RenameDurability;
+    QTest::newRow("deferred") << KConfig::DeferredDurability;
+}
+
+void KConfigTest::testDurability()
+{
+    QFETCH(KConfig::Durability, durability);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("durabilityrc"));
+
+    KConfig config(path, KConfig::SimpleConfig);
+    QCOMPARE(config.durability(), KConfig::FullDurability);
+    config.setDurability(durability);
+    QCOMPARE(config.durability(), durability);
+
+    KConfigGroup group = config.group(QStringLiteral("Group"));
+    group.writeEntry("Key", 1);
+    QVERIFY(config.sync());
+    QCOMPARE(KConfig(path, KConfig::SimpleConfig).group(QStringLiteral("Group")).readEntry("Key", 0), 1);
+
+#ifndef Q_OS_WIN
+    // the mode of an existing file is kept
+    QVERIFY(!QFile::permissions(path).testFlag(QFile::ReadGroup));
+    QVERIFY(QFile::setPermissions(path, QFile::permissions(path) | QFile::ReadGroup));
+#endif
+    group.writeEntry("Key", 2);
+    QVERIFY(config.sync());
+    QCOMPARE(KConfig(path, KConfig::SimpleConfig).group(QStringLiteral("Group")).readEntry("Key", 0), 2);
+#ifndef Q_OS_WIN
+    QVERIFY(QFile::permissions(path).testFlag(QFile::ReadGroup));
+#endif
+
+    // no temporary files are left behind
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files), QStringList{QStringLiteral("durabilityrc")});
+}
+
 #include <QThreadPool>
 #include <QtConcurrentRun>
 
@@ -2309,8 +2553,15 @@ void KConfigTest::testKAuthorizeEnums()
 
     QVERIFY(!KAuthorized::authorize(KAuthorized::SHELL_ACCESS));
     QVERIFY(!KAuthorized::authorizeAction(KAuthorized::OPEN_WITH));
+    QVERIFY(!KAuthorized::authorize(QStringLiteral("shell_access")));
+    QVERIFY(!KAuthorized::authorizeAction(QStringLiteral("open_with")));
+    QVERIFY(KAuthorized::authorize(KAuthorized::GHNS));
     actionRestrictions.deleteGroup();
 
+    // the compiled restrictions follow changes of the config
+    QVERIFY(KAuthorized::authorize(KAuthorized::SHELL_ACCESS));
+    QVERIFY(KAuthorized::authorizeAction(KAuthorized::OPEN_WITH));
+
     QVERIFY(!KAuthorized::authorize((KAuthorized::GenericRestriction)0));
     QVERIFY(!KAuthorized::authorizeAction((KAuthorized::GenericAction)0));
 }
@@ -2519,6 +2770,50 @@ void KConfigTest::testSystemAndUserConfig()
     QDir(userConfigDir + testSubDir).removeRecursively();
 }
 
+void KConfigTest::testLocateCache()
+{
+#ifndef Q_XDG_PLATFORM
+    QSKIP("This test relies on XDG_CONFIG_DIRS, which only has effect on Unix.");
+#endif
+
+    QTemporaryDir systemDir;
+    EnvironmentVariableOverride xdgConfigDirsOverride{"XDG_CONFIG_DIRS", qPrintable(systemDir.path())};
+
+    const QString userConfigDir = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation);
+    const QString configFileName = u"locatecachetestrc"_s;
+    const QString systemFile = systemDir.path() + u'/' + configFileName;
+    const QString userFile = userConfigDir + u'/' + configFileName;
+    QVERIFY(writeTextFile(userFile,
+                          "[General]\n"_L1
+                          "user=1\n"_L1));
+    // where the file was found is only remembered for directories not modified in the last two seconds
+    ageTimeStamp(systemDir.path(), 10);
+    ageTimeStamp(userConfigDir, 10);
+
+    KConfig config(configFileName, KConfig::NoGlobals);
+    KConfigGroup group(&config, u"General"_s);
+    QCOMPARE(group.readEntry("user", 0), 1);
+    QCOMPARE(group.readEntry("system", 0), 0);
+
+    // adding a file changes the modification time of its directory, which is still old enough to be remembered
+    QVERIFY(writeTextFile(systemFile,
+                          "[General]\n"_L1
+                          "system=2\n"_L1));
+    ageTimeStamp(systemDir.path(), 5);
+    config.reparseConfiguration();
+    QCOMPARE(group.readEntry("system", 0), 2);
+    QCOMPARE(group.readEntry("user", 0), 1);
+
+    // and so does removing it
+    QVERIFY(QFile::remove(systemFile));
+    ageTimeStamp(systemDir.path(), 3);
+    config.reparseConfiguration();
+    QCOMPARE(group.readEntry("system", 0), 0);
+    QCOMPARE(group.readEntry("user", 0), 1);
+
+    QFile::remove(userFile);
+}
+
 void KConfigTest::testImmutableFiles()
 {
 #ifndef Q_XDG_PLATFORM
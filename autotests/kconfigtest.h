@@ -85,6 +85,12 @@ private Q_SLOTS:
     void testLocalDeletion();
     void testNewlines();
     void testXdgListEntry();
+    void testListRoundTrip();
+    void testKeyHandle();
+    void testSharedEntryData();
+    void testForeignTranslations();
+    void testDurability_data();
+    void testDurability();
     void testNotify();
     void testNotifyIllegalObjectPath();
     void testKAuthorizeEnums();
@@ -96,6 +102,7 @@ private Q_SLOTS:
 
     void testOpenFlags();
     void testSystemAndUserConfig();
+    void testLocateCache();
 
     // these tests overwrite the kdeglobals file created by initTestCase()
     void testImmutableFiles();
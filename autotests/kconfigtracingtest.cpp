@@ -0,0 +1,119 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QLockFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <numeric>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KConfigTracing>
+
+class KConfigTracingTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        KConfigTracing::setEnabled(true);
+    }
+
+    void init()
+    {
+        KConfigTracing::reset();
+    }
+
+    void testParseAndSync()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("tracingrc"));
+
+        {
+            KConfig config(path, KConfig::SimpleConfig);
+            KConfigGroup group(&config, QStringLiteral("Group"));
+            group.writeEntry("Key1", 1);
+            group.writeEntry("Key2", QStringLiteral("two"));
+            QVERIFY(config.sync());
+        }
+
+        KConfig config(path, KConfig::SimpleConfig);
+        config.reparseConfiguration();
+
+        const auto statistics = KConfigTracing::statistics();
+        const QString id = QFileInfo(path).canonicalFilePath();
+        QVERIFY(statistics.contains(id));
+
+        const KConfigTracing::FileStatistics stats = statistics.value(id);
+        QCOMPARE(stats.syncCount, quint64(1));
+        QCOMPARE(stats.writeCount, quint64(1));
+        QCOMPARE(stats.lockCount, quint64(1));
+        QCOMPARE(std::accumulate(stats.lockWaitHistogram.cbegin(), stats.lockWaitHistogram.cend(), quint64(0)), stats.lockCount);
+        // our own files are replaced atomically, parses don't lock them
+        QCOMPARE(stats.sharedLockCount, quint64(0));
+        // the merge parse during sync is followed by the parses of the second object
+        QVERIFY(stats.parseCount >= 2);
+        QVERIFY(stats.bytesRead > 0);
+        // one group marker and two keys
+        QCOMPARE(stats.entryCount, quint64(3));
+        QCOMPARE(stats.reparseTriggers.value(QStringLiteral("open")), quint64(2));
+        QCOMPARE(stats.reparseTriggers.value(QStringLiteral("direct")), quint64(1));
+        QCOMPARE(stats.reparseCount, quint64(3));
+    }
+
+    void testNoSharedLockForOwnFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("tracinglockrc"));
+        {
+            KConfig config(path, KConfig::SimpleConfig);
+            config.group(QStringLiteral("Group")).writeEntry("Key", 1);
+            QVERIFY(config.sync());
+        }
+        KConfig config(path, KConfig::SimpleConfig);
+        KConfigTracing::reset();
+
+        // a writer of our own file replaces it atomically, so the parse doesn't wait for it
+        QLockFile writerLock(QFileInfo(path).canonicalFilePath() + QLatin1String(".lock"));
+        QVERIFY(writerLock.tryLock());
+        config.reparseConfiguration();
+        QCOMPARE(config.group(QStringLiteral("Group")).readEntry("Key", 0), 1);
+        writerLock.unlock();
+
+        const KConfigTracing::FileStatistics stats = KConfigTracing::statistics().value(QFileInfo(path).canonicalFilePath());
+        QCOMPARE(stats.parseCount, quint64(1));
+        QCOMPARE(stats.sharedLockCount, quint64(0));
+    }
+
+    void testDisabled()
+    {
+        KConfigTracing::setEnabled(false);
+        KConfig config(QStringLiteral("tracingdisabledrc"), KConfig::SimpleConfig);
+        config.reparseConfiguration();
+        KConfigTracing::setEnabled(true);
+
+        QVERIFY(KConfigTracing::statistics().isEmpty());
+    }
+
+    void testJson()
+    {
+        KConfig config(QStringLiteral("tracingjsonrc"), KConfig::SimpleConfig);
+        config.reparseConfiguration();
+
+        const QByteArray json = KConfigTracing::toJson();
+        QVERIFY(json.contains("reparseCount"));
+        QVERIFY(json.contains("tracingjsonrc"));
+    }
+};
+
+QTEST_GUILESS_MAIN(KConfigTracingTest)
+
+#include "kconfigtracingtest.moc"
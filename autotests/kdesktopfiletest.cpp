@@ -5,15 +5,21 @@
 */
 #include "kdesktopfiletest.h"
 #include "helper.h"
+#include <QDateTime>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <kconfiggroup.h>
 #include <kdesktopfileaction.h>
+#include <kdesktopfileindex.h>
+#include <kdesktopfilerecord.h>
 #include <ksharedconfig.h>
 
 #include "kdesktopfile.h"
 
 #include <QTest>
 
+#include <memory>
+
 #if defined(Q_OS_UNIX)
 #include <unistd.h>
 #endif
@@ -229,6 +235,19 @@ void KDesktopFileTest::testIsAuthorizedDesktopFile()
 
     QVERIFY(!KDesktopFile::isAuthorizedDesktopFile(fileName));
 
+#if defined(Q_OS_UNIX)
+    if (QFileInfo(fileName).ownerId() != 0) {
+        // let the verdict become cacheable, then make sure making the file executable invalidates it.
+        // Verdicts on files changed in the current second aren't kept, and the status change time
+        // can't be set like the modification time, so wait until that second is over.
+        const qint64 changed = QFileInfo(fileName).metadataChangeTime().toSecsSinceEpoch();
+        QTRY_VERIFY_WITH_TIMEOUT(QDateTime::currentSecsSinceEpoch() > changed, 2000);
+        QVERIFY(!KDesktopFile::isAuthorizedDesktopFile(fileName));
+        QVERIFY(QFile::setPermissions(fileName, QFile::permissions(fileName) | QFile::ExeUser));
+        QVERIFY(KDesktopFile::isAuthorizedDesktopFile(fileName));
+    }
+#endif
+
     const QString autostartFile = QStandardPaths::locate(QStandardPaths::GenericConfigLocation, QStringLiteral("autostart/plasma-desktop.desktop"));
     if (!autostartFile.isEmpty()) {
         QVERIFY(KDesktopFile::isAuthorizedDesktopFile(autostartFile));
@@ -378,4 +397,178 @@ void KDesktopFileTest::testSubstituteUidAdminAccountFallback()
     }
 }
 
+void KDesktopFileTest::testDesktopFileIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString high = dir.filePath(QStringLiteral("high"));
+    const QString low = dir.filePath(QStringLiteral("low"));
+    QVERIFY(QDir().mkpath(high));
+    QVERIFY(QDir().mkpath(low + QStringLiteral("/kde")));
+
+    auto writeDesktopFile = [](const QString &path, const QByteArray &contents) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("[Desktop Entry]\nType=Application\n" + contents);
+    };
+    writeDesktopFile(high + QStringLiteral("/app.desktop"), "Name=High\nIcon=high\n");
+    writeDesktopFile(low + QStringLiteral("/app.desktop"), "Name=Low\n");
+    writeDesktopFile(low + QStringLiteral("/kde/viewer.desktop"),
+                     "Name=Viewer\nNoDisplay=true\nMimeType=image/png;image/jpeg;\nActions=Open;Print\n\n[Desktop Action Open]\nName=Open\n");
+    writeDesktopFile(low + QStringLiteral("/notadesktopfile.txt"), "Name=Text\n");
+
+    {
+        KDesktopFileIndex index(QStringList{high, low});
+        QCOMPARE(index.desktopFileIds(), (QStringList{QStringLiteral("app.desktop"), QStringLiteral("kde-viewer.desktop")}));
+
+        // the directory listed first wins
+        QCOMPARE(index.locate(QStringLiteral("app.desktop")), high + QStringLiteral("/app.desktop"));
+        QCOMPARE(index.readName(QStringLiteral("app.desktop")), QStringLiteral("High"));
+        QCOMPARE(index.readIcon(QStringLiteral("app.desktop")), QStringLiteral("high"));
+        QCOMPARE(index.readType(QStringLiteral("app.desktop")), QStringLiteral("Application"));
+        QVERIFY(!index.noDisplay(QStringLiteral("app.desktop")));
+        QVERIFY(index.readMimeTypes(QStringLiteral("app.desktop")).isEmpty());
+
+        const QString viewer = QStringLiteral("kde-viewer.desktop");
+        const KDesktopFile desktopFile(index.locate(viewer));
+        QCOMPARE(index.readName(viewer), desktopFile.readName());
+        QCOMPARE(index.noDisplay(viewer), desktopFile.noDisplay());
+        QCOMPARE(index.readMimeTypes(viewer), desktopFile.readMimeTypes());
+        QCOMPARE(index.readActions(viewer), desktopFile.readActions());
+
+        QVERIFY(!index.contains(QStringLiteral("notadesktopfile.txt")));
+        QVERIFY(!index.record(QStringLiteral("missing.desktop")).isValid());
+
+        // changes show up after an update
+        writeDesktopFile(low + QStringLiteral("/kde/new.desktop"), "Name=New\n");
+        QVERIFY(QFile::remove(high + QStringLiteral("/app.desktop")));
+        QVERIFY(!index.contains(QStringLiteral("kde-new.desktop")));
+        index.update();
+        QCOMPARE(index.readName(QStringLiteral("kde-new.desktop")), QStringLiteral("New"));
+        QCOMPARE(index.readName(QStringLiteral("app.desktop")), QStringLiteral("Low"));
+    }
+
+    // a new index of the same directories starts from the cache file
+    KDesktopFileIndex index(QStringList{high, low});
+    QCOMPARE(index.desktopFileIds().size(), 3);
+    QCOMPARE(index.readName(QStringLiteral("app.desktop")), QStringLiteral("Low"));
+    QCOMPARE(index.readMimeTypes(QStringLiteral("kde-viewer.desktop")), (QStringList{QStringLiteral("image/png"), QStringLiteral("image/jpeg")}));
+
+    QVERIFY(QDir(low + QStringLiteral("/kde")).removeRecursively());
+    index.update();
+    QCOMPARE(index.desktopFileIds(), QStringList{QStringLiteral("app.desktop")});
+
+    // a file that can't be read still hides the files of the same id with lower priority
+    {
+        QFile broken(high + QStringLiteral("/app.desktop"));
+        QVERIFY(broken.open(QIODevice::WriteOnly));
+        broken.write("Name=Broken\n");
+    }
+    index.update();
+    QVERIFY(!index.contains(QStringLiteral("app.desktop")));
+    QVERIFY(index.locate(QStringLiteral("app.desktop")).isEmpty());
+    QVERIFY(index.desktopFileIds().isEmpty());
+    QVERIFY(QFile::remove(high + QStringLiteral("/app.desktop")));
+
+#ifdef Q_OS_UNIX
+    // a link to a parent directory is only followed once
+    QVERIFY(QDir().mkpath(low + QStringLiteral("/kde")));
+    writeDesktopFile(low + QStringLiteral("/kde/viewer.desktop"), "Name=Viewer\n");
+    QVERIFY(QFile::link(low, low + QStringLiteral("/kde/loop")));
+    index.update();
+    QCOMPARE(index.desktopFileIds(), (QStringList{QStringLiteral("app.desktop"), QStringLiteral("kde-viewer.desktop")}));
+    QCOMPARE(index.readName(QStringLiteral("app.desktop")), QStringLiteral("Low"));
+#endif
+}
+
 #include "moc_kdesktopfiletest.cpp"
+
+void KDesktopFileTest::testReadRecordsLocalized_data()
+{
+    testReadLocalized_data();
+}
+
+void KDesktopFileTest::testReadRecordsLocalized()
+{
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/testReadRecordsLocalizedXXXXXX.desktop"));
+    QVERIFY(file.open());
+    const QString fileName = file.fileName();
+    QTextStream ts(&file);
+    ts << "[Desktop Entry]\n"
+          "Type=Application\n"
+          "Name=My Application\n"
+          "Name[de]=Meine Anwendung\n"
+          "Name[de@freiburg]=Mein Anwendungsle\n"
+          "Name[de_CH]=Mein Anwendungsli\n"
+          "Icon=foo\n"
+          "\n";
+    file.close();
+
+    DefaultLocale defaultLocale;
+
+    QFETCH(QLocale, locale);
+    QLocale::setDefault(locale);
+    const QList<KDesktopFileRecord> records = KDesktopFile::readRecords({fileName}, {QStringLiteral("Name")});
+    QCOMPARE(records.size(), 1);
+
+    QEXPECT_FAIL("de@freiburg", "QLocale doesn't support modifiers", Continue);
+    QTEST(records.at(0).value(QStringLiteral("Name")), "translation");
+}
+
+void KDesktopFileTest::testReadRecords()
+{
+    // enough files to be read by several threads
+    QList<std::shared_ptr<QTemporaryFile>> files;
+    QStringList paths;
+    for (int i = 0; i < 40; ++i) {
+        auto file = std::make_shared<QTemporaryFile>(QDir::tempPath() + QStringLiteral("/testReadRecordsXXXXXX.desktop"));
+        QVERIFY(file->open());
+        QTextStream ts(file.get());
+        ts << "# comment\n"
+              "[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=App "
+           << i
+           << "\n"
+              "Comment=With\\sescapes\n"
+              "Icon[$e]=$HOME/icon.png\n"
+              "Empty=\n"
+              "\n"
+              "[Desktop Action New]\n"
+              "Name=New Window\n"
+              "Exec=app --new\n";
+        file->close();
+        paths.append(file->fileName());
+        files.append(file);
+    }
+    paths.append(QDir::tempPath() + QStringLiteral("/doesnotexist.desktop"));
+    paths.append(QStringLiteral("relative.desktop"));
+
+    const QStringList keys{QStringLiteral("Name"), QStringLiteral("Comment"), QStringLiteral("Icon"), QStringLiteral("Exec"), QStringLiteral("Empty")};
+    const QList<KDesktopFileRecord> records = KDesktopFile::readRecords(paths, keys);
+    QCOMPARE(records.size(), paths.size());
+
+    for (int i = 0; i < 40; ++i) {
+        const KDesktopFileRecord &record = records.at(i);
+        QVERIFY(record.isValid());
+        QCOMPARE(record.path(), paths.at(i));
+        QCOMPARE(record.keys(), keys);
+
+        const KDesktopFile desktopFile(paths.at(i));
+        QCOMPARE(record.value(QStringLiteral("Name")), desktopFile.readName());
+        QCOMPARE(record.value(QStringLiteral("Comment")), QStringLiteral("With escapes"));
+        QCOMPARE(record.value(QStringLiteral("Icon")), desktopFile.readIcon());
+        QCOMPARE(record.value(QStringLiteral("Icon")), QDir::homePath() + QStringLiteral("/icon.png"));
+        // only [Desktop Entry] is read
+        QVERIFY(!record.hasKey(QStringLiteral("Exec")));
+        QCOMPARE(record.value(QStringLiteral("Exec"), QStringLiteral("default")), QStringLiteral("default"));
+        QVERIFY(record.hasKey(QStringLiteral("Empty")));
+        QVERIFY(record.value(QStringLiteral("Empty")).isEmpty());
+        // keys that weren't asked for are unknown
+        QVERIFY(!record.hasKey(QStringLiteral("Type")));
+    }
+
+    QVERIFY(!records.at(40).isValid());
+    QVERIFY(!records.at(41).isValid());
+    QVERIFY(!records.at(41).hasKey(QStringLiteral("Name")));
+}
@@ -27,6 +27,10 @@ private Q_SLOTS:
     void testLocateLocal();
     void testWritePrimaryGroupFirst();
     void testSubstituteUidAdminAccountFallback();
+    void testReadRecordsLocalized_data();
+    void testReadRecordsLocalized();
+    void testReadRecords();
+    void testDesktopFileIndex();
 };
 
 #endif /* KDESKTOPFILETEST_H */
@@ -18,6 +18,8 @@ class KSharedConfigTest : public QObject
 private Q_SLOTS:
     void initTestCase();
     void testUnicity();
+    void testUnicityByFlagsAndLocation();
+    void testMainConfigName();
     void testAnonymousConfig();
     void testReadWrite();
     void testReadWriteSync();
@@ -50,19 +52,20 @@ private Q_SLOTS:
         QVERIFY(QFile::exists(path));
     }
 
+    // The migration tests use names of their own, the outcome for a name is only looked up once per process
     void testStateMigration()
     {
         QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
         // Migrate from old file to new file if new file doesn't exist yet
-        const QString oldPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/"_L1 + QCoreApplication::applicationName() + "staterc"_L1;
+        const QString oldPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/migrationstaterc"_L1;
         QVERIFY(QFile(oldPath).open(QFile::WriteOnly | QFile::Truncate));
         QVERIFY(QFile::exists(oldPath));
-        const QString newPath = m_stateDirPath + "/"_L1 + QCoreApplication::applicationName() + "staterc"_L1;
+        const QString newPath = m_stateDirPath + "/migrationstaterc"_L1;
         if (QFile::exists(newPath)) {
             QFile::remove(newPath); // make sure new file doesn't exist so we can write to it
         }
 
-        auto config = KSharedConfig::openStateConfig();
+        auto config = KSharedConfig::openStateConfig(u"migrationstaterc"_s);
         config->group(u"Test"_s).writeEntry("Test", true);
         config->sync();
         QVERIFY(!QFile::exists(oldPath));
@@ -73,20 +76,39 @@ private Q_SLOTS:
     {
         QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
         // Both old and new staterc exist -> keep both
-        const QString oldPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/"_L1 + QCoreApplication::applicationName() + "staterc"_L1;
+        const QString oldPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/migrationclashstaterc"_L1;
         QVERIFY(QFile(oldPath).open(QFile::WriteOnly | QFile::Truncate));
         QVERIFY(QFile::exists(oldPath));
         QDir().mkpath(m_stateDirPath);
-        const QString newPath = m_stateDirPath + "/"_L1 + QCoreApplication::applicationName() + "staterc"_L1;
-        QVERIFY(QFile(oldPath).open(QFile::WriteOnly | QFile::Truncate));
-        QVERIFY(QFile::exists(oldPath));
+        const QString newPath = m_stateDirPath + "/migrationclashstaterc"_L1;
+        QVERIFY(QFile(newPath).open(QFile::WriteOnly | QFile::Truncate));
+        QVERIFY(QFile::exists(newPath));
 
-        auto config = KSharedConfig::openStateConfig();
+        auto config = KSharedConfig::openStateConfig(u"migrationclashstaterc"_s);
         config->group(u"Test"_s).writeEntry("Test", true);
         config->sync();
         QVERIFY(QFile::exists(oldPath));
         QVERIFY(QFile::exists(newPath));
     }
+
+    void testStateMigrationNothingToMigrate()
+    {
+        const QString oldPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/latelegacystaterc"_L1;
+        const QString newPath = m_stateDirPath + "/latelegacystaterc"_L1;
+        QFile::remove(oldPath);
+        QFile::remove(newPath);
+
+        // no legacy file, and none is looked for again when the config is opened the next time
+        KSharedConfig::openStateConfig(u"latelegacystaterc"_s);
+        QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+        QVERIFY(QFile(oldPath).open(QFile::WriteOnly | QFile::Truncate));
+
+        auto config = KSharedConfig::openStateConfig(u"latelegacystaterc"_s);
+        QCOMPARE(config->name(), newPath);
+        QVERIFY(QFile::exists(oldPath));
+        QVERIFY(!QFile::exists(newPath));
+        QFile::remove(oldPath);
+    }
 #endif
 
 private:
@@ -116,6 +138,40 @@ void KSharedConfigTest::testUnicity()
     QCOMPARE(cfg1.data(), cfg2.data());
 }
 
+void KSharedConfigTest::testUnicityByFlagsAndLocation()
+{
+    const QString name = u"ksharedconfigtest_unicityrc"_s;
+    KSharedConfig::Ptr full = KSharedConfig::openConfig(name);
+    KSharedConfig::Ptr simple = KSharedConfig::openConfig(name, KConfig::SimpleConfig);
+    KSharedConfig::Ptr state = KSharedConfig::openConfig(name, KConfig::SimpleConfig, QStandardPaths::GenericStateLocation);
+    QVERIFY(full.data() != simple.data());
+    QVERIFY(simple.data() != state.data());
+
+    QCOMPARE(KSharedConfig::openConfig(name).data(), full.data());
+    QCOMPARE(KSharedConfig::openConfig(name, KConfig::SimpleConfig).data(), simple.data());
+    QCOMPARE(KSharedConfig::openConfig(name, KConfig::SimpleConfig, QStandardPaths::GenericStateLocation).data(), state.data());
+
+    // once the last reference is gone, the config is opened again
+    simple.reset();
+    simple = KSharedConfig::openConfig(name, KConfig::SimpleConfig);
+    QCOMPARE(simple->name(), name);
+    QCOMPARE(KSharedConfig::openConfig(name, KConfig::SimpleConfig).data(), simple.data());
+}
+
+void KSharedConfigTest::testMainConfigName()
+{
+    KSharedConfig::Ptr mainConfig = KSharedConfig::openConfig();
+    QCOMPARE(mainConfig->name(), KConfig::mainConfigName());
+
+    KConfig::setMainConfigName(u"ksharedconfigtest_otherrc"_s);
+    KSharedConfig::Ptr otherConfig = KSharedConfig::openConfig();
+    QCOMPARE(otherConfig->name(), u"ksharedconfigtest_otherrc"_s);
+    QCOMPARE(KSharedConfig::openConfig().data(), otherConfig.data());
+
+    KConfig::setMainConfigName(QString());
+    QCOMPARE(KSharedConfig::openConfig().data(), mainConfig.data());
+}
+
 void KSharedConfigTest::testAnonymousConfig()
 {
     QTest::failOnWarning();
@@ -51,6 +51,9 @@ void KStandardShortcutTest::testFindStdAccel()
 {
     QCOMPARE(KStandardShortcut::find(QKeySequence(Qt::CTRL | Qt::Key_F)), KStandardShortcut::Find);
     QCOMPARE(KStandardShortcut::find(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::ALT | Qt::Key_G)), KStandardShortcut::AccelNone);
+    QCOMPARE(KStandardShortcut::find(QKeySequence()), KStandardShortcut::AccelNone);
+    // the second default of Close
+    QCOMPARE(KStandardShortcut::find(QKeySequence(Qt::CTRL | Qt::Key_Escape)), KStandardShortcut::Close);
 }
 
 void KStandardShortcutTest::testFindByName()
@@ -59,6 +62,8 @@ void KStandardShortcutTest::testFindByName()
         const auto id = static_cast<KStandardShortcut::StandardShortcut>(i);
         QCOMPARE(id, KStandardShortcut::findByName(KStandardShortcut::name(id)));
     }
+    QCOMPARE(KStandardShortcut::findByName(QStringLiteral("NoSuchShortcut")), KStandardShortcut::AccelNone);
+    QCOMPARE(KStandardShortcut::findByName(QString()), KStandardShortcut::AccelNone);
 }
 
 #include "moc_kstandardshortcuttest.cpp"
@@ -21,6 +21,8 @@ private Q_SLOTS:
     void init();
     void testSignal();
     void testDataUpdated();
+    void testFindUpdated();
+    void testDuplicatesRemoved();
 };
 
 Q_DECLARE_METATYPE(KStandardShortcut::StandardShortcut)
@@ -69,5 +71,31 @@ void KStandardShortcutWatcherTest::testDataUpdated()
     QCOMPARE(KStandardShortcut::open(), newShortcut);
 }
 
+void KStandardShortcutWatcherTest::testFindUpdated()
+{
+    const QKeySequence defaultSequence = KStandardShortcut::hardcodedDefaultShortcut(KStandardShortcut::Open).constFirst();
+    QCOMPARE(KStandardShortcut::find(defaultSequence), KStandardShortcut::Open);
+    QCOMPARE(KStandardShortcut::find(newShortcut.constFirst()), KStandardShortcut::AccelNone);
+
+    KStandardShortcut::saveShortcut(KStandardShortcut::Open, newShortcut);
+    QCOMPARE(KStandardShortcut::find(newShortcut.constFirst()), KStandardShortcut::Open);
+    QCOMPARE(KStandardShortcut::find(defaultSequence), KStandardShortcut::AccelNone);
+
+    KStandardShortcut::saveShortcut(KStandardShortcut::Open, KStandardShortcut::hardcodedDefaultShortcut(KStandardShortcut::Open));
+    QCOMPARE(KStandardShortcut::find(defaultSequence), KStandardShortcut::Open);
+}
+
+void KStandardShortcutWatcherTest::testDuplicatesRemoved()
+{
+    KConfigGroup group(KSharedConfig::openConfig(), QStringLiteral("Shortcuts"));
+    group.writeEntry("Close", QStringLiteral("Ctrl+W; Ctrl+Esc; Ctrl+W; Ctrl+Esc; Ctrl+W"), KConfig::Global);
+    KStandardShortcut::initialize(KStandardShortcut::Close);
+    QCOMPARE(KStandardShortcut::close(), (QList<QKeySequence>{Qt::CTRL | Qt::Key_W, Qt::CTRL | Qt::Key_Escape}));
+
+    group.deleteEntry("Close", KConfig::Global);
+    KStandardShortcut::initialize(KStandardShortcut::Close);
+    QCOMPARE(KStandardShortcut::close(), KStandardShortcut::hardcodedDefaultShortcut(KStandardShortcut::Close));
+}
+
 QTEST_MAIN(KStandardShortcutWatcherTest)
 #include "kstandardshortcutwatchertest.moc"
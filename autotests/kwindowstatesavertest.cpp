@@ -13,6 +13,8 @@
 
 #include <QProgressDialog>
 
+#include <algorithm>
+
 class KWindowStateSaverTest : public QObject
 {
     Q_OBJECT
@@ -20,6 +22,7 @@ private Q_SLOTS:
     void initTestCase();
     void testTopLevelDialog();
     void testSubDialog();
+    void testCoalescedSaves();
 };
 
 void KWindowStateSaverTest::initTestCase()
@@ -86,5 +89,40 @@ void KWindowStateSaverTest::testSubDialog()
     }
 }
 
+void KWindowStateSaverTest::testCoalescedSaves()
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group = config.group(QStringLiteral("coalescedSavesTest"));
+
+    QProgressDialog dlg;
+    auto saver = new KWindowStateSaver(&dlg, group);
+    dlg.show();
+    QTest::qWait(10); // give the window time to show up, so we simulate a user-triggered resize
+
+    // a burst of resizes is written once, with the final size
+    dlg.resize(500, 400);
+    dlg.resize(520, 420);
+    dlg.resize(540, 440);
+    QVERIFY(group.keyList().isEmpty());
+    QTRY_VERIFY(!group.keyList().isEmpty());
+    const QStringList keys = group.keyList();
+    const auto width = std::find_if(keys.cbegin(), keys.cend(), [](const QString &key) {
+        return key.endsWith(QLatin1String("Width"));
+    });
+    QVERIFY(width != keys.cend());
+    QCOMPARE(group.readEntry(*width, 0), 540);
+
+    // nothing of the burst is written again
+    group.deleteGroup();
+    QTest::qWait(300);
+    QVERIFY(group.keyList().isEmpty());
+
+    // a change still waiting to be written isn't lost when the saver goes away
+    dlg.resize(560, 460);
+    QVERIFY(group.keyList().isEmpty());
+    delete saver;
+    QCOMPARE(group.readEntry(*width, 0), 560);
+}
+
 QTEST_MAIN(KWindowStateSaverTest)
 #include "kwindowstatesavertest.moc"
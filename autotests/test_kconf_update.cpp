@@ -9,10 +9,13 @@
 #include <memory>
 
 // Qt
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QProcess>
 #include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QTest>
 #include <qglobal.h>
@@ -143,4 +146,90 @@ void TestKConfUpdate::testScript()
     QCOMPARE(readFile(confPath), expectedNewConfContent);
 }
 
+// Runs kconf_update like at session start, on the update files installed below dir, and returns its debug output
+static QString runInstalledKConfUpdate(const QTemporaryDir &dir)
+{
+    const QString kconfUpdateExecutable = QFINDTESTDATA("kconf_update");
+    if (!QFile::exists(kconfUpdateExecutable)) {
+        return QString();
+    }
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("XDG_DATA_HOME"), dir.filePath(QStringLiteral("data")));
+    env.insert(QStringLiteral("XDG_DATA_DIRS"), dir.filePath(QStringLiteral("sysdata")));
+    env.insert(QStringLiteral("XDG_CONFIG_HOME"), dir.filePath(QStringLiteral("config")));
+    env.remove(QStringLiteral("QT_LOGGING_RULES"));
+    QProcess p;
+    p.setProcessEnvironment(env);
+    p.start(kconfUpdateExecutable, QStringList{QStringLiteral("--debug")});
+    if (!p.waitForFinished() || p.exitCode() != 0) {
+        return QString();
+    }
+    return QString::fromLocal8Bit(p.readAllStandardError());
+}
+
+void TestKConfUpdate::testSkipUnchangedUpdateFiles()
+{
+    if (QStandardPaths::findExecutable(QStringLiteral("sh")).isEmpty()) {
+        QSKIP("Could not find sh executable, cannot run test");
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString updDir = dir.filePath(QStringLiteral("data/kconf_update"));
+    QVERIFY(QDir().mkpath(updDir));
+    const QString logPath = dir.filePath(QStringLiteral("log"));
+    writeFile(updDir + QLatin1String("/log.sh"), QLatin1String("echo $1 >> '%1'\n").arg(logPath));
+    const QString updPath = updDir + QLatin1String("/test.upd");
+    writeFile(updPath, QStringLiteral("Version=6\nId=first\nScriptArguments=first\nScript=log.sh,sh\n"));
+
+    const QString skipMessage = QStringLiteral("No update files changed since the last run");
+    QString out = runInstalledKConfUpdate(dir);
+    QVERIFY(!out.isEmpty());
+    QVERIFY(!out.contains(skipMessage));
+    QCOMPARE(readFile(logPath), QStringLiteral("first\n"));
+
+    out = runInstalledKConfUpdate(dir);
+    QVERIFY2(out.contains(skipMessage), qPrintable(out));
+    QCOMPARE(readFile(logPath), QStringLiteral("first\n"));
+
+    // overwriting the file in place, like cp or cmake --install do, doesn't change the directory
+    const QDateTime dirModified = QFileInfo(updDir).lastModified();
+    QFile upd(updPath);
+    QVERIFY(upd.open(QIODevice::WriteOnly | QIODevice::Append));
+    upd.write("Id=second\nScriptArguments=second\nScript=log.sh,sh\n");
+    upd.close();
+    QVERIFY(upd.open(QIODevice::ReadWrite));
+    QVERIFY(upd.setFileTime(QDateTime::currentDateTime().addSecs(10), QFileDevice::FileModificationTime));
+    upd.close();
+    QCOMPARE(QFileInfo(updDir).lastModified(), dirModified);
+
+    out = runInstalledKConfUpdate(dir);
+    QVERIFY2(!out.isEmpty() && !out.contains(skipMessage), qPrintable(out));
+    QCOMPARE(readFile(logPath), QStringLiteral("first\nsecond\n"));
+
+    out = runInstalledKConfUpdate(dir);
+    QVERIFY2(out.contains(skipMessage), qPrintable(out));
+}
+
+void TestKConfUpdate::testRescanAfterFailure()
+{
+    if (QStandardPaths::findExecutable(QStringLiteral("sh")).isEmpty()) {
+        QSKIP("Could not find sh executable, cannot run test");
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString updDir = dir.filePath(QStringLiteral("data/kconf_update"));
+    QVERIFY(QDir().mkpath(updDir));
+    writeFile(updDir + QLatin1String("/fail.sh"), QStringLiteral("exit 1\n"));
+    writeFile(updDir + QLatin1String("/test.upd"), QStringLiteral("Version=6\nId=failing\nScript=fail.sh,sh\n"));
+
+    // a failed run doesn't count as complete, the next run checks the update files again
+    const QString skipMessage = QStringLiteral("No update files changed since the last run");
+    QString out = runInstalledKConfUpdate(dir);
+    QVERIFY2(out.contains(QLatin1String("An error occurred while running")), qPrintable(out));
+    out = runInstalledKConfUpdate(dir);
+    QVERIFY2(!out.isEmpty() && !out.contains(skipMessage), qPrintable(out));
+}
+
 #include "moc_test_kconf_update.cpp"
@@ -16,6 +16,8 @@ private Q_SLOTS:
     void initTestCase();
     void testScript_data();
     void testScript();
+    void testSkipUnchangedUpdateFiles();
+    void testRescanAfterFailure();
 };
 
 #endif /* TEST_KCONF_UPDATE_H */
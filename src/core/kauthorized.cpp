@@ -6,11 +6,21 @@
 */
 
 #include "kauthorized.h"
+#include "kconfig_p.h"
 
 #include <QDebug>
 #include <QDir>
 #include <QList>
+#include <QMetaEnum>
+#include <QSet>
+#include <QThreadStorage>
 #include <QUrl>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
 
 #include "kconfig_core_log_settings.h"
 #include <QCoreApplication>
@@ -175,6 +185,207 @@ public:
 
 Q_DECLARE_TYPEINFO(URLActionRule, Q_RELOCATABLE_TYPE);
 
+/*
+ * Immutable view of a list of URL action rules, grouped by action and by the
+ * destination protocol a rule can match, so that a check only runs baseMatch()
+ * and destMatch() on the few rules that can apply to it.
+ *
+ * The outcome is the same as scanning the whole list: the permission of the
+ * last matching rule wins, and nothing matching means the action is denied.
+ */
+class URLActionIndex
+{
+public:
+    explicit URLActionIndex(const QList<URLActionRule> &rules)
+        : m_rules(rules)
+    {
+        for (qsizetype i = 0; i < m_rules.size(); ++i) {
+            const URLActionRule &rule = m_rules.at(i);
+            ActionRules &actionRules = m_actions[QString::fromLatin1(rule.action)];
+            if (rule.destProtEqual || rule.destProt.isEmpty()) {
+                actionRules.anyProt.append(i);
+            } else if (rule.destProtWildCard) {
+                actionRules.byProtPrefix[rule.destProt].append(i);
+            } else {
+                actionRules.byProt[rule.destProt].append(i);
+            }
+        }
+    }
+
+    bool authorize(const QString &action, const QUrl &baseURL, const QUrl &destURL, const QString &baseClass, const QString &destClass) const
+    {
+        const auto actionIt = m_actions.constFind(action);
+        if (actionIt == m_actions.cend()) {
+            return false;
+        }
+        const ActionRules &actionRules = actionIt.value();
+
+        // Rules naming a protocol match by the protocol of the destination or by its class
+        QVarLengthArray<qsizetype, 32> candidates;
+        auto addCandidates = [&candidates](const QHash<QString, QList<qsizetype>> &rules, const QString &prot) {
+            const auto it = rules.constFind(prot);
+            if (it != rules.cend()) {
+                candidates.append(it->constData(), it->size());
+            }
+        };
+        const QString scheme = destURL.scheme();
+        addCandidates(actionRules.byProt, scheme);
+        for (qsizetype length = 1; length <= scheme.size(); ++length) {
+            addCandidates(actionRules.byProtPrefix, scheme.left(length));
+        }
+        if (!destClass.isEmpty() && destClass != scheme) {
+            addCandidates(actionRules.byProt, destClass);
+            addCandidates(actionRules.byProtPrefix, destClass);
+        }
+        candidates.append(actionRules.anyProt.constData(), actionRules.anyProt.size());
+
+        std::sort(candidates.begin(), candidates.end(), std::greater<qsizetype>());
+        qsizetype previous = -1;
+        for (const qsizetype i : std::as_const(candidates)) {
+            if (i == previous) {
+                continue;
+            }
+            previous = i;
+            const URLActionRule &rule = m_rules.at(i);
+            if (rule.baseMatch(baseURL, baseClass) && rule.destMatch(destURL, destClass, baseURL, baseClass)) {
+                return rule.permission;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct ActionRules {
+        // indexes into m_rules, in rule order
+        QHash<QString, QList<qsizetype>> byProt;
+        QHash<QString, QList<qsizetype>> byProtPrefix;
+        QList<qsizetype> anyProt;
+    };
+
+    const QList<URLActionRule> m_rules;
+    QHash<QString, ActionRules> m_actions;
+};
+
+/*
+ * The rules added at runtime through allowUrlAction(), e.g. by KIO for every
+ * redirect it follows. They only ever allow and come after all configured rules,
+ * so any of them matching means the action is allowed.
+ *
+ * Checks look up exactly what was allowed in a hash. Everything else goes through
+ * an immutable URLActionIndex of all rules, rebuilt whenever a rule is added, so
+ * that it can be matched without holding the lock of KAuthorizedPrivate.
+ *
+ * The rules are unbounded unless setMaxSize() asks for a limit. Then the rule
+ * added, or added again, least recently is dropped first.
+ */
+class AllowedUrlActions
+{
+public:
+    void add(const URLActionRule &rule)
+    {
+        const Key key{QString::fromLatin1(rule.action), rule.baseProt, rule.baseHost, rule.basePath, rule.destProt, rule.destHost, rule.destPath};
+        if (const auto it = m_keys.constFind(key); it != m_keys.cend()) {
+            m_rules.splice(m_rules.begin(), m_rules, it.value());
+            return;
+        }
+        m_rules.push_front(rule);
+        m_keys.insert(key, m_rules.begin());
+        trim();
+        rebuildIndex();
+    }
+
+    // Whether exactly this was allowed, the common case for redirects
+    bool contains(const QString &action, const QUrl &baseURL, const QUrl &destURL) const
+    {
+        if (m_keys.isEmpty()) {
+            return false;
+        }
+        return m_keys.contains(Key{action, baseURL.scheme(), baseURL.host(), baseURL.path(), destURL.scheme(), destURL.host(), destURL.path()});
+    }
+
+    // All rules, null if there are none
+    std::shared_ptr<const URLActionIndex> index() const
+    {
+        return m_index;
+    }
+
+    void clear()
+    {
+        m_keys.clear();
+        m_rules.clear();
+        m_index.reset();
+    }
+
+    qsizetype size() const
+    {
+        return m_keys.size();
+    }
+
+    qsizetype maxSize() const
+    {
+        return m_maxSize;
+    }
+
+    // 0 means unbounded
+    void setMaxSize(qsizetype maxSize)
+    {
+        m_maxSize = maxSize;
+        if (trim()) {
+            rebuildIndex();
+        }
+    }
+
+private:
+    struct Key {
+        QString action;
+        QString baseProt;
+        QString baseHost;
+        QString basePath;
+        QString destProt;
+        QString destHost;
+        QString destPath;
+
+        bool operator==(const Key &other) const
+        {
+            return action == other.action && baseProt == other.baseProt && baseHost == other.baseHost && basePath == other.basePath
+                && destProt == other.destProt && destHost == other.destHost && destPath == other.destPath;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.action, key.baseProt, key.baseHost, key.basePath, key.destProt, key.destHost, key.destPath);
+        }
+    };
+
+    // Returns whether rules were dropped
+    bool trim()
+    {
+        bool dropped = false;
+        while (m_maxSize > 0 && m_keys.size() > m_maxSize) {
+            const URLActionRule &rule = m_rules.back();
+            m_keys.remove(Key{QString::fromLatin1(rule.action), rule.baseProt, rule.baseHost, rule.basePath, rule.destProt, rule.destHost, rule.destPath});
+            m_rules.pop_back();
+            dropped = true;
+        }
+        return dropped;
+    }
+
+    void rebuildIndex()
+    {
+        if (m_rules.empty()) {
+            m_index.reset();
+            return;
+        }
+        // all rules allow, their order doesn't matter
+        m_index = std::make_shared<const URLActionIndex>(QList<URLActionRule>(m_rules.cbegin(), m_rules.cend()));
+    }
+
+    // most recently added first
+    std::list<URLActionRule> m_rules;
+    QHash<Key, std::list<URLActionRule>::iterator> m_keys;
+    std::shared_ptr<const URLActionIndex> m_index;
+    qsizetype m_maxSize = 0;
+};
+
 class KAuthorizedPrivate
 {
 public:
@@ -201,12 +412,84 @@ public:
     bool actionRestrictions : 1;
     bool blockEverything : 1;
     QList<URLActionRule> urlActionRestrictions;
+    // built from urlActionRestrictions on demand, reset whenever they change
+    std::shared_ptr<const URLActionIndex> urlActionIndex;
+    AllowedUrlActions allowedUrlActions;
     QRecursiveMutex mutex;
 };
 
 Q_GLOBAL_STATIC(KAuthorizedPrivate, authPrivate)
 #define KAUTHORIZED_D KAuthorizedPrivate *d = authPrivate()
 
+/*
+ * Compiled view of the [KDE Action Restrictions] group of a config.
+ */
+struct RestrictionTable {
+    void build(const KConfig *config)
+    {
+        deniedActions.clear();
+        deniedUiActions.clear();
+        const KConfigGroup cg(config, QStringLiteral("KDE Action Restrictions"));
+        const QStringList keys = cg.keyList();
+        const QLatin1String actionPrefix("action/");
+        for (const QString &key : keys) {
+            if (!cg.readEntry(key, true)) {
+                deniedActions.insert(key);
+                if (key.startsWith(actionPrefix)) {
+                    deniedUiActions.insert(key.mid(actionPrefix.size()));
+                }
+            }
+        }
+
+        fillEnumTable(QMetaEnum::fromType<KAuthorized::GenericRestriction>(), deniedActions, allowedRestrictions);
+        fillEnumTable(QMetaEnum::fromType<KAuthorized::GenericAction>(), deniedUiActions, allowedActions);
+    }
+
+    // The lower cased key of an enum value names the action, e.g. SHELL_ACCESS is "shell_access"
+    static void fillEnumTable(const QMetaEnum &metaEnum, const QSet<QString> &denied, QList<bool> &table)
+    {
+        int maxValue = 0;
+        for (int i = 0; i < metaEnum.keyCount(); ++i) {
+            maxValue = std::max(maxValue, metaEnum.value(i));
+        }
+
+        table.fill(true, maxValue + 1);
+        for (int i = 0; i < metaEnum.keyCount(); ++i) {
+            const int value = metaEnum.value(i);
+            if (value > 0) {
+                table[value] = !denied.contains(QString::fromLatin1(metaEnum.key(i)).toLower());
+            }
+        }
+    }
+
+    // generation of the config the table was built from, 0 if never built
+    quint64 generation = 0;
+    QSet<QString> deniedActions;
+    // keys of deniedActions with the "action/" prefix, without it
+    QSet<QString> deniedUiActions;
+    // indexed by GenericRestriction and GenericAction values, index 0 is unused
+    QList<bool> allowedRestrictions;
+    QList<bool> allowedActions;
+};
+
+// KSharedConfig::openConfig() is a different object in every thread, so every thread keeps the
+// table of its own main config. Checks need no lock then, and don't rebuild the table each
+// time they come from another thread than the previous one.
+static QThreadStorage<RestrictionTable> s_restrictionTables;
+
+// The table of the main config of the current thread, rebuilt if its entries changed
+static const RestrictionTable &restrictionTable()
+{
+    const KSharedConfig::Ptr config = KSharedConfig::openConfig();
+    RestrictionTable &table = s_restrictionTables.localData();
+    const quint64 generation = KConfigPrivate::entryGeneration(config.data());
+    if (table.generation != generation) {
+        table.build(config.data());
+        table.generation = generation;
+    }
+    return table;
+}
+
 KAuthorized::KAuthorized()
     : QObject(nullptr)
 {
@@ -223,16 +506,19 @@ bool KAuthorized::authorize(const QString &genericAction)
         return true;
     }
 
-    KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("KDE Action Restrictions"));
-    return cg.readEntry(genericAction, true);
+    return !restrictionTable().deniedActions.contains(genericAction);
 }
 
 bool KAuthorized::authorize(KAuthorized::GenericRestriction action)
 {
-    const QMetaEnum metaEnum = QMetaEnum::fromType<KAuthorized::GenericRestriction>();
+    KAUTHORIZED_D;
+    if (d->blockEverything) {
+        return false;
+    }
 
-    if (metaEnum.isValid() && action != 0) {
-        return KAuthorized::authorize(QString::fromLatin1(metaEnum.valueToKey(action)).toLower());
+    const RestrictionTable &table = restrictionTable();
+    if (action > 0 && action < table.allowedRestrictions.size()) {
+        return !d->actionRestrictions || table.allowedRestrictions.at(action);
     }
     qCWarning(KCONFIG_CORE_LOG) << "Invalid GenericRestriction requested" << action;
     return false;
@@ -248,14 +534,19 @@ bool KAuthorized::authorizeAction(const QString &action)
         return true;
     }
 
-    return authorize(QLatin1String("action/") + action);
+    return !restrictionTable().deniedUiActions.contains(action);
 }
 
 bool KAuthorized::authorizeAction(KAuthorized::GenericAction action)
 {
-    const QMetaEnum metaEnum = QMetaEnum::fromType<KAuthorized::GenericAction>();
-    if (metaEnum.isValid() && action != 0) {
-        return KAuthorized::authorizeAction(QString::fromLatin1(metaEnum.valueToKey(action)).toLower());
+    KAUTHORIZED_D;
+    if (d->blockEverything) {
+        return false;
+    }
+
+    const RestrictionTable &table = restrictionTable();
+    if (action > 0 && action < table.allowedActions.size()) {
+        return !d->actionRestrictions || table.allowedActions.at(action);
     }
     qCWarning(KCONFIG_CORE_LOG) << "Invalid GenericAction requested" << action;
     return false;
@@ -276,7 +567,10 @@ KCONFIGCORE_EXPORT void loadUrlActionRestrictions(const KConfigGroup &cg)
     KAUTHORIZED_D;
     const QString Any;
 
+    QMutexLocker locker(&d->mutex);
+    d->urlActionIndex.reset();
     d->urlActionRestrictions.clear();
+    d->allowedUrlActions.clear();
     d->urlActionRestrictions.append(URLActionRule("open", Any, Any, Any, Any, Any, Any, true));
     d->urlActionRestrictions.append(URLActionRule("list", Any, Any, Any, Any, Any, Any, true));
     // TEST:
@@ -345,6 +639,15 @@ KCONFIGCORE_EXPORT void loadUrlActionRestrictions(const KConfigGroup &cg)
     }
 }
 
+// Must be called with the mutex held
+static void ensureUrlActionRestrictions(KAuthorizedPrivate *d)
+{
+    if (d->urlActionRestrictions.isEmpty()) {
+        KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("KDE URL Restrictions"));
+        loadUrlActionRestrictions(cg);
+    }
+}
+
 namespace KAuthorizedInternal
 {
 /*
@@ -355,13 +658,37 @@ KCONFIGCORE_EXPORT void allowUrlAction(const QString &action, const QUrl &_baseU
     KAUTHORIZED_D;
     QMutexLocker locker((&d->mutex));
 
+    // load the configured rules first, loading them drops the allowed ones
+    ensureUrlActionRestrictions(d);
+
     const QString basePath = _baseURL.adjusted(QUrl::StripTrailingSlash).path();
     const QString destPath = _destURL.adjusted(QUrl::StripTrailingSlash).path();
 
-    d->urlActionRestrictions.append(
+    d->allowedUrlActions.add(
         URLActionRule(action.toLatin1(), _baseURL.scheme(), _baseURL.host(), basePath, _destURL.scheme(), _destURL.host(), destPath, true));
 }
 
+/*
+ * Number of rules added through allowUrlAction() that are currently kept
+ */
+KCONFIGCORE_EXPORT qsizetype allowedUrlActionCount()
+{
+    KAUTHORIZED_D;
+    QMutexLocker locker((&d->mutex));
+    return d->allowedUrlActions.size();
+}
+
+/*
+ * Limits how many rules added through allowUrlAction() are kept, the ones added least
+ * recently are dropped first. 0, the default, keeps all of them.
+ */
+KCONFIGCORE_EXPORT void setMaxAllowedUrlActions(qsizetype maxCount)
+{
+    KAUTHORIZED_D;
+    QMutexLocker locker((&d->mutex));
+    d->allowedUrlActions.setMaxSize(maxCount);
+}
+
 /*
  * Helper for KAuthorized::authorizeUrlAction in KIO
  */
@@ -369,7 +696,6 @@ KCONFIGCORE_EXPORT bool
 authorizeUrlAction(const QString &action, const QUrl &_baseURL, const QUrl &_destURL, const QString &baseClass, const QString &destClass)
 {
     KAUTHORIZED_D;
-    QMutexLocker locker(&(d->mutex));
     if (d->blockEverything) {
         return false;
     }
@@ -378,26 +704,33 @@ authorizeUrlAction(const QString &action, const QUrl &_baseURL, const QUrl &_des
         return true;
     }
 
-    bool result = false;
-    if (d->urlActionRestrictions.isEmpty()) {
-        KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("KDE URL Restrictions"));
-        loadUrlActionRestrictions(cg);
-    }
-
     QUrl baseURL(_baseURL);
     baseURL.setPath(QDir::cleanPath(baseURL.path()));
 
     QUrl destURL(_destURL);
     destURL.setPath(QDir::cleanPath(destURL.path()));
 
-    for (const URLActionRule &rule : std::as_const(d->urlActionRestrictions)) {
-        if ((result != rule.permission) && // No need to check if it doesn't make a difference
-            (action == QLatin1String(rule.action.constData())) && rule.baseMatch(baseURL, baseClass)
-            && rule.destMatch(destURL, destClass, baseURL, baseClass)) {
-            result = rule.permission;
+    // Only take the lock to get hold of the indexes, matching happens on the immutable snapshots
+    std::shared_ptr<const URLActionIndex> allowedIndex;
+    std::shared_ptr<const URLActionIndex> index;
+    {
+        QMutexLocker locker(&(d->mutex));
+        ensureUrlActionRestrictions(d);
+        if (d->allowedUrlActions.contains(action, baseURL, destURL)) {
+            return true;
         }
+        allowedIndex = d->allowedUrlActions.index();
+        if (!d->urlActionIndex) {
+            d->urlActionIndex = std::make_shared<const URLActionIndex>(d->urlActionRestrictions);
+        }
+        index = d->urlActionIndex;
+    }
+
+    // the allowed rules come after the configured ones, so they have the last word
+    if (allowedIndex && allowedIndex->authorize(action, baseURL, destURL, baseClass, destClass)) {
+        return true;
     }
-    return result;
+    return index->authorize(action, baseURL, destURL, baseClass, destClass);
 }
 } // namespace
 
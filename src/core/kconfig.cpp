@@ -13,6 +13,7 @@
 #include "config-kconfig.h"
 #include "dbussanitizer_p.h"
 #include "kconfig_core_log_settings.h"
+#include "kconfigtracing_p.h"
 
 #include <fcntl.h>
 
@@ -22,8 +23,11 @@
 #include <QByteArray>
 #include <QCache>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QLocale>
 #include <QMutexLocker>
 #include <QProcess>
@@ -54,6 +58,7 @@ static bool s_globalFilesAreInitialized = false;
 Q_GLOBAL_STATIC(QStringList, s_globalSystemFiles) // For caching purposes.
 Q_GLOBAL_STATIC(QStringList, s_globalUserFiles) // For caching purposes.
 static QBasicMutex s_globalFilesMutex;
+static QBasicAtomicInteger<quint64> s_entryGeneration = Q_BASIC_ATOMIC_INITIALIZER(0);
 Q_GLOBAL_STATIC_WITH_ARGS(QString, sGlobalFileName, (QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QLatin1String("/kdeglobals")))
 
 using ParseCacheKey = std::pair<QStringList, QString>;
@@ -65,6 +70,85 @@ struct ParseCacheValue {
 };
 QThreadStorage<QCache<ParseCacheKey, ParseCacheValue>> sGlobalParse;
 
+namespace
+{
+// What QStandardPaths::locateAll() finds for a config file, and the canonical paths of it
+struct LocatedFiles {
+    QStringList paths;
+    QStringList canonicalPaths;
+};
+
+// QStandardPaths::locateAll() results shared by all KConfig objects of the process, so that
+// reparsing or opening the same file again doesn't look for it in every directory again.
+// Adding, removing or renaming a file changes the modification time of its directory,
+// so a result stays valid as long as the directories it was looked up in keep theirs.
+class LocateCache
+{
+public:
+    LocatedFiles locateAll(QStandardPaths::StandardLocation type, const QString &fileName);
+
+private:
+    struct Entry {
+        QStringList directories;
+        QList<qint64> directoryTimes;
+        LocatedFiles files;
+    };
+
+    QMutex mutex;
+    QHash<std::pair<int, QString>, Entry> entries;
+};
+
+LocatedFiles LocateCache::locateAll(QStandardPaths::StandardLocation type, const QString &fileName)
+{
+    // the directories the file may be in, which can be subdirectories of the standard locations
+    QStringList directories = QStandardPaths::standardLocations(type);
+    if (const qsizetype slash = fileName.lastIndexOf(QLatin1Char('/')); slash > 0) {
+        for (QString &directory : directories) {
+            directory += QLatin1Char('/') + QStringView(fileName).left(slash);
+        }
+    }
+
+    // a change within the same time unit as the one before can't be told apart by the times,
+    // so results from directories modified very recently are not kept
+    const qint64 recently = QDateTime::currentMSecsSinceEpoch() - 2000;
+    bool keepResult = true;
+    QList<qint64> directoryTimes;
+    directoryTimes.reserve(directories.size());
+    for (const QString &directory : std::as_const(directories)) {
+        const QFileInfo info(directory);
+        const qint64 time = info.exists() ? info.lastModified(QTimeZone::UTC).toMSecsSinceEpoch() : -1;
+        keepResult = keepResult && time < recently;
+        directoryTimes << time;
+    }
+
+    const auto key = std::make_pair(int(type), fileName);
+    {
+        QMutexLocker locker(&mutex);
+        const auto it = entries.constFind(key);
+        if (it != entries.cend() && it->directories == directories && it->directoryTimes == directoryTimes) {
+            return it->files;
+        }
+    }
+
+    LocatedFiles files;
+    files.paths = QStandardPaths::locateAll(type, fileName);
+    files.canonicalPaths.reserve(files.paths.size());
+    for (const QString &path : std::as_const(files.paths)) {
+        files.canonicalPaths << QFileInfo(path).canonicalFilePath();
+    }
+
+    QMutexLocker locker(&mutex);
+    if (keepResult) {
+        entries.insert(key, Entry{directories, directoryTimes, files});
+    } else {
+        entries.remove(key);
+    }
+    return files;
+}
+
+Q_GLOBAL_STATIC(LocateCache, s_locateCache)
+} // namespace
+
 #ifndef Q_OS_WIN
 static const Qt::CaseSensitivity sPathCaseSensitivity = Qt::CaseSensitive;
 #else
@@ -91,6 +175,11 @@ static QString getDefaultLocaleName()
     return QLocale().name();
 }
 
+QString KConfigPrivate::defaultLocaleName()
+{
+    return getDefaultLocaleName();
+}
+
 KConfigPrivate::KConfigPrivate(KConfig::OpenFlags flags,
                                QStandardPaths::StandardLocation resourceType,
                                std::unique_ptr<KConfigIniBackendAbstractDevice> backend)
@@ -102,8 +191,12 @@ KConfigPrivate::KConfigPrivate(KConfig::OpenFlags flags,
     , bFileImmutable(false)
     , bForceGlobal(false)
     , bSuppressGlobal(false)
+    , entryMap(KEntryMap::ArenaAllocation)
+    , generation(0)
     , configState(KConfigBase::NoAccess)
 {
+    entriesChanged();
+
     const bool isTestMode = QStandardPaths::isTestModeEnabled();
     // If sGlobalFileName was initialised and testMode has been toggled,
     // sGlobalFileName may need to be updated to point to the correct kdeglobals file
@@ -132,6 +225,11 @@ KConfigPrivate::KConfigPrivate(KConfig::OpenFlags flags,
     setLocale(getDefaultLocaleName());
 }
 
+void KConfigPrivate::entriesChanged()
+{
+    generation = s_entryGeneration.fetchAndAddRelaxed(1) + 1;
+}
+
 bool KConfigPrivate::lockLocal()
 {
     return mBackend.lock();
@@ -153,8 +251,9 @@ void KConfigPrivate::copyGroup(const QString &source, const QString &destination
     // the group is empty, we don't end up marking the other config
     // as dirty erroneously
     bool dirtied = false;
+    bool copied = false;
 
-    entryMap.forEachEntryWhoseGroupStartsWith(source, [&source, &destination, flags, &otherMap, sameName, &dirtied](KEntryMapConstIterator entryMapIt) {
+    entryMap.forEachEntryWhoseGroupStartsWith(source, [&source, &destination, flags, &otherMap, sameName, &dirtied, &copied](KEntryMapConstIterator entryMapIt) {
         // don't copy groups that start with the same prefix, but are not sub-groups
         if (!isGroupOrSubGroupMatch(entryMapIt, source)) {
             return;
@@ -182,11 +281,16 @@ void KConfigPrivate::copyGroup(const QString &source, const QString &destination
         }
 
         otherMap[newKey] = entry;
+        copied = true;
     });
 
     if (dirtied) {
         otherGroup->config()->d_ptr->bDirty = true;
     }
+    // so that KConfigKey handles and KAuthorized of the other config don't keep the old values
+    if (copied) {
+        otherGroup->config()->d_ptr->entriesChanged();
+    }
 }
 
 QString KConfigPrivate::expandString(const QString &value)
@@ -256,6 +360,7 @@ KConfig::KConfig(const QString &file, OpenFlags mode, QStandardPaths::StandardLo
     d_ptr->changeFileName(file); // set the local file name
 
     // read initial information off disk
+    KConfigTracingInternal::ScopedReparseTrigger trigger(QLatin1StringView("open"));
     reparseConfiguration();
 }
 
@@ -268,6 +373,7 @@ KConfig::KConfig(const std::shared_ptr<QIODevice> &device, OpenFlags mode)
     d_ptr->configState = d_ptr->mBackend.accessMode();
 
     // read initial information off device
+    KConfigTracingInternal::ScopedReparseTrigger trigger(QLatin1StringView("open"));
     reparseConfiguration();
 }
 
@@ -443,6 +549,10 @@ bool KConfig::sync()
     QHash<QString, QByteArrayList> notifyGroupsGlobal;
 
     if (d->bDirty) {
+        if (KConfigTracing::isEnabled()) {
+            KConfigTracingInternal::recordSync(d->mBackend.deviceId());
+        }
+
         const QByteArray utf8Locale(locale().toUtf8());
 
         // Create the containing dir, maybe it wasn't there
@@ -576,6 +686,7 @@ KConfig *KConfig::copyTo(const QString &file, KConfig *config) const
     config->d_func()->changeFileName(file);
     config->d_func()->entryMap = d->entryMap;
     config->d_func()->bFileImmutable = false;
+    config->d_func()->entriesChanged();
 
     for (auto &[_, entry] : config->d_func()->entryMap) {
         entry.bDirty = true;
@@ -590,6 +701,7 @@ void KConfig::copyFrom(const KConfig &config) const
     Q_D(const KConfig);
     d_ptr->entryMap = config.d_func()->entryMap;
     d_ptr->bFileImmutable = false;
+    d_ptr->entriesChanged();
 
     for (auto &[_, entry] : d_ptr->entryMap) {
         entry.bDirty = true;
@@ -618,11 +730,18 @@ struct KConfigStaticData {
 };
 Q_GLOBAL_STATIC(KConfigStaticData, globalData)
 static QBasicMutex s_globalDataMutex;
+static QBasicAtomicInteger<quint64> s_mainConfigNameSerial = Q_BASIC_ATOMIC_INITIALIZER(0);
 
 void KConfig::setMainConfigName(const QString &str)
 {
     QMutexLocker locker(&s_globalDataMutex);
     globalData()->globalMainConfigName = str;
+    s_mainConfigNameSerial.fetchAndAddRelaxed(1);
+}
+
+quint64 KConfigPrivate::mainConfigNameSerial()
+{
+    return s_mainConfigNameSerial.loadRelaxed();
 }
 
 QString KConfig::mainConfigName()
@@ -693,12 +812,17 @@ void KConfig::reparseConfiguration()
         return;
     }
 
+    if (KConfigTracing::isEnabled()) {
+        KConfigTracingInternal::recordReparse(d->mBackend.deviceId());
+    }
+
     // Don't lose pending changes
     if (!d->isReadOnly() && d->bDirty) {
         sync();
     }
 
     d->entryMap.clear();
+    d->entriesChanged();
 
     d->bFileImmutable = false;
 
@@ -736,8 +860,8 @@ void KConfigPrivate::ensureGlobalFilesAreInitialized() const
     QMutexLocker locker(&s_globalFilesMutex);
     if (!s_globalFilesAreInitialized) {
         const QString writableLocation = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation);
-        const QStringList paths1 = QStandardPaths::locateAll(QStandardPaths::GenericConfigLocation, QStringLiteral("kdeglobals"));
-        const QStringList paths2 = QStandardPaths::locateAll(QStandardPaths::GenericConfigLocation, QStringLiteral("system.kdeglobals"));
+        const QStringList paths1 = s_locateCache()->locateAll(QStandardPaths::GenericConfigLocation, QStringLiteral("kdeglobals")).paths;
+        const QStringList paths2 = s_locateCache()->locateAll(QStandardPaths::GenericConfigLocation, QStringLiteral("system.kdeglobals")).paths;
 
         const bool useEtcKderc = !etc_kderc.isEmpty();
         const bool writableInPaths1 = !paths1.isEmpty() && paths1.front().startsWith(writableLocation);
@@ -864,12 +988,10 @@ void KConfigPrivate::parseSystemConfigFiles()
     QList<QString> files;
     if (!bSuppressGlobal && !QDir::isAbsolutePath(fileName)) {
         const QString writableLocation = QStandardPaths::writableLocation(resourceType);
-        QStringList localFilesPath = QStandardPaths::locateAll(resourceType, fileName);
-        if (!localFilesPath.isEmpty() && localFilesPath.front().startsWith(writableLocation)) {
-            localFilesPath.removeFirst();
-        }
-        for (const QString &f : localFilesPath) {
-            files.prepend(QFileInfo(f).canonicalFilePath());
+        const LocatedFiles localFiles = s_locateCache()->locateAll(resourceType, fileName);
+        const qsizetype first = !localFiles.paths.isEmpty() && localFiles.paths.front().startsWith(writableLocation) ? 1 : 0;
+        for (qsizetype i = first; i < localFiles.canonicalPaths.size(); ++i) {
+            files.prepend(localFiles.canonicalPaths.at(i));
         }
         // allow fallback to config files bundled in resources
         const QString resourceFile(QStringLiteral(":/kconfig/") + fileName);
@@ -910,9 +1032,9 @@ void KConfigPrivate::parseUserConfigFiles()
                 }
             } else {
                 const QString writableLocation = QStandardPaths::writableLocation(resourceType);
-                const QString localFilePath = QStandardPaths::locate(resourceType, fileName);
-                if (localFilePath.startsWith(writableLocation)) {
-                    files << QFileInfo(localFilePath).canonicalFilePath();
+                const LocatedFiles localFiles = s_locateCache()->locateAll(resourceType, fileName);
+                if (!localFiles.paths.isEmpty() && localFiles.paths.front().startsWith(writableLocation)) {
+                    files << localFiles.canonicalPaths.front();
                 }
             }
         }
@@ -1000,7 +1122,10 @@ bool KConfig::setLocale(const QString &locale)
 void KConfig::setReadDefaults(bool b)
 {
     Q_D(KConfig);
-    d->bReadDefaults = b;
+    if (d->bReadDefaults != b) {
+        d->bReadDefaults = b;
+        d->entriesChanged();
+    }
 }
 
 bool KConfig::readDefaults() const
@@ -1009,6 +1134,18 @@ bool KConfig::readDefaults() const
     return d->bReadDefaults;
 }
 
+void KConfig::setDurability(Durability durability)
+{
+    Q_D(KConfig);
+    d->mBackend.setDurability(durability);
+}
+
+KConfig::Durability KConfig::durability() const
+{
+    Q_D(const KConfig);
+    return d->mBackend.durability();
+}
+
 bool KConfig::isImmutable() const
 {
     Q_D(const KConfig);
@@ -1062,6 +1199,7 @@ void KConfig::deleteGroupImpl(const QString &aGroup, WriteConfigFlags flags)
             if (d->canWriteEntry(group, key)) {
                 d->entryMap.setEntry(group, key, QByteArray(), options);
                 d->bDirty = true;
+                d->entriesChanged();
             }
         }
     }
@@ -1125,8 +1263,11 @@ void KConfigPrivate::putData(const QString &group, const char *key, const QByteA
     }
 
     bool dirtied = entryMap.setEntry(group, key, value, options);
-    if (dirtied && (flags & KConfigBase::Persistent)) {
-        bDirty = true;
+    if (dirtied) {
+        entriesChanged();
+        if (flags & KConfigBase::Persistent) {
+            bDirty = true;
+        }
     }
 }
 
@@ -1137,6 +1278,7 @@ void KConfigPrivate::revertEntry(const QString &group, QAnyStringView key, KConf
     bool dirtied = entryMap.revertEntry(group, key, options);
     if (dirtied) {
         bDirty = true;
+        entriesChanged();
     }
 }
 
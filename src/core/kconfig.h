@@ -101,6 +101,32 @@ public:
     };
     Q_DECLARE_FLAGS(OpenFlags, OpenFlag)
 
+    /*!
+     * Determines how much effort sync() puts into making sure that the written
+     * file survives a system crash or power loss.
+     *
+     * With any of them the file is replaced atomically: other processes, and the
+     * file after a crash of the application, show either the old or the new contents.
+     * Only full durability makes sure the new contents reach the disk before
+     * sync() returns, which can take long, in particular on network file systems.
+     *
+     * On Android and on non-Unix platforms, files are always written with full durability.
+     *
+     * \value FullDurability The new file is flushed to disk before it replaces the old one. The default.
+     * \value RenameDurability The new file replaces the old one without waiting for the disk.
+     *        After a system crash the file may have old or even no contents.
+     * \value DeferredDurability Like RenameDurability, and the file is flushed to disk in the
+     *        background about a second later, together with other files written meanwhile.
+     *
+     * \since 6.30
+     * \sa setDurability()
+     */
+    enum Durability {
+        FullDurability,
+        RenameDurability,
+        DeferredDurability,
+    };
+
     /*!
      * Creates a KConfig object to manipulate a configuration file for the
      * current application.
@@ -314,6 +340,25 @@ public:
      */
     bool readDefaults() const;
 
+    /*!
+     * Sets how durably sync() writes the file to \a durability.
+     *
+     * Files whose loss after a system crash doesn't matter much, like the ones
+     * opened with KSharedConfig::openStateConfig() that remember window sizes or
+     * recently used files, can be written faster with a lower durability.
+     *
+     * Global entries, which sync() writes to kdeglobals, are always written with full durability.
+     *
+     * \since 6.30
+     */
+    void setDurability(Durability durability);
+
+    /*!
+     * Returns how durably sync() writes the file.
+     * \since 6.30
+     */
+    Durability durability() const;
+
     bool isImmutable() const override;
 
     QStringList groupList() const override;
@@ -42,6 +42,7 @@ public:
     {
         if (entryMap.setEntry(groupName, key, value, flags)) {
             bDirty = true;
+            entriesChanged();
         }
     }
     void revertEntry(const QString &group, QAnyStringView key, KConfigBase::WriteConfigFlags flags);
@@ -66,6 +67,24 @@ public:
     void notifyClients(const QHash<QString, QByteArrayList> &changes, const QString &path);
 
     static QString expandString(const QString &value);
+    // The locale KConfig objects translate entries to by default
+    static QString defaultLocaleName();
+
+    /*
+     * Returns a value that changes whenever what \a config returns for its entries
+     * may have changed, i.e. after a reparse, a write, a revert or a group deletion.
+     * The values are unique across all KConfig objects of the process, so caches
+     * derived from a config's entries only need to remember this number.
+     */
+    static quint64 entryGeneration(const KConfig *config)
+    {
+        return config->d_func()->generation;
+    }
+
+    /*
+     * Returns a value that changes whenever KConfig::setMainConfigName() is called.
+     */
+    static quint64 mainConfigNameSerial();
 
 protected:
     KConfigIniBackend mBackend;
@@ -88,6 +107,7 @@ private:
     static bool mappingsRegistered;
 
     KEntryMap entryMap;
+    quint64 generation;
     QString backendType;
     QStack<QString> extraFiles;
 
@@ -113,6 +133,7 @@ private:
         return configState == KConfig::ReadOnly;
     }
 
+    void entriesChanged();
     bool setLocale(const QString &aLocale);
     void ensureGlobalFilesAreInitialized() const;
     QStringList getGlobalSystemFiles() const;
@@ -14,6 +14,16 @@
 #include <QDebug>
 #include <QString>
 #include <map>
+#include <memory>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+// std::pmr is missing in the libc++ of older macOS and Android versions, maps allocate from the heap there
+#ifdef __cpp_lib_memory_resource
+#include <memory_resource>
+#define KCONFIG_USE_ENTRY_MAP_ARENA 1
+#endif
 
 /*
  * map/dict/list config node entry.
@@ -253,6 +263,82 @@ inline KEntryKeyView minimumGroupKeyView(const QString &group)
 QDebug operator<<(QDebug dbg, const KEntryKey &key);
 QDebug operator<<(QDebug dbg, const KEntry &entry);
 
+#ifdef KCONFIG_USE_ENTRY_MAP_ARENA
+using KEntryMapAllocator = std::pmr::polymorphic_allocator<std::pair<const KEntryKey, KEntry>>;
+#else
+using KEntryMapAllocator = std::allocator<std::pair<const KEntryKey, KEntry>>;
+#endif
+
+/*
+ * Owns the arena the nodes of a KEntryMap are allocated from, if it has one.
+ * It's a base class of KEntryMap so that it outlives the nodes.
+ *
+ * The arena hands out memory in growing blocks and frees it all at once. A pool
+ * on top of it keeps the nodes that were erased and reuses them for new ones.
+ *
+ * Copies of a map allocate from the heap, and assigning a map to another one
+ * keeps the memory of the target, like with std::pmr containers.
+ */
+class KEntryMapArena
+{
+protected:
+    explicit KEntryMapArena(bool useArena)
+    {
+#ifdef KCONFIG_USE_ENTRY_MAP_ARENA
+        if (useArena) {
+            m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>(s_initialArenaSize);
+            m_pool = std::make_unique<std::pmr::unsynchronized_pool_resource>(m_arena.get());
+        }
+#else
+        Q_UNUSED(useArena);
+#endif
+    }
+    KEntryMapArena(const KEntryMapArena &)
+    {
+    }
+    KEntryMapArena(KEntryMapArena &&) = default;
+    KEntryMapArena &operator=(const KEntryMapArena &)
+    {
+        return *this;
+    }
+    KEntryMapArena &operator=(KEntryMapArena &&)
+    {
+        return *this;
+    }
+    ~KEntryMapArena() = default;
+
+#ifdef KCONFIG_USE_ENTRY_MAP_ARENA
+    KEntryMapAllocator allocator() const
+    {
+        return KEntryMapAllocator(m_pool ? m_pool.get() : std::pmr::get_default_resource());
+    }
+
+    void releaseArena()
+    {
+        if (m_arena) {
+            m_pool->release();
+            m_arena->release();
+        }
+    }
+
+private:
+    // room for a few dozen entries, the following blocks grow geometrically
+    static constexpr std::size_t s_initialArenaSize = 4096;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+    // declared after m_arena, which it allocates from
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> m_pool;
+#else
+    KEntryMapAllocator allocator() const
+    {
+        return KEntryMapAllocator();
+    }
+
+    void releaseArena()
+    {
+    }
+#endif
+};
+
 /*
  * \relates KEntry
  * type specifying a map of entries (key,value pairs).
@@ -260,10 +346,33 @@ QDebug operator<<(QDebug dbg, const KEntry &entry);
  * with the group name.
  *
  */
-class KEntryMap final : private std::map<KEntryKey, KEntry, KEntryKeyCompare>
+class KEntryMap final : private KEntryMapArena, private std::map<KEntryKey, KEntry, KEntryKeyCompare, KEntryMapAllocator>
 {
-    using super_t = std::map<KEntryKey, KEntry, KEntryKeyCompare>;
+    using super_t = std::map<KEntryKey, KEntry, KEntryKeyCompare, KEntryMapAllocator>;
 public:
+    enum Allocation {
+        // every node is allocated and freed on its own
+        HeapAllocation,
+        // Nodes are allocated from an arena, which is freed at once by clear() and the destructor.
+        // Erased nodes are kept for new ones, so a map that keeps erasing and inserting, like the
+        // entries of a long-lived KConfig holding a recent files list, doesn't grow, but the memory
+        // only goes back to the heap when the map is cleared, e.g. by a reparse, or destroyed.
+        // Not thread-safe, like KEntryMap itself. Without std::pmr, this is the same as HeapAllocation.
+        ArenaAllocation,
+    };
+
+    explicit KEntryMap(Allocation allocation = HeapAllocation)
+        : KEntryMapArena(allocation == ArenaAllocation)
+        , super_t(allocator())
+    {
+    }
+
+    void clear()
+    {
+        super_t::clear();
+        releaseArena();
+    }
+
     enum SearchFlag {
         SearchDefaults = 1,
         SearchLocalized = 2,
@@ -289,7 +398,6 @@ public:
     using super_t::cbegin;
     using super_t::cend;
     using super_t::empty;
-    using super_t::clear;
     using super_t::iterator;
     using super_t::const_iterator;
     using super_t::operator[];
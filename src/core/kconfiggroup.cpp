@@ -115,6 +115,30 @@ public:
         return fullName() + QLatin1Char('\x1d') + aGroup;
     }
 
+    // Reads key as a string like readEntry() does, expanding it even without [$e] if alwaysExpand is set
+    QString readString(QAnyStringView key, const QString &aDefault, bool alwaysExpand) const
+    {
+        bool expand = false;
+
+        // read value from the entry map
+        QString aValue = mOwner->d_func()->lookupData(fullName(), key, KEntryMap::SearchLocalized, &expand);
+        if (aValue.isNull()) {
+            aValue = aDefault;
+        }
+
+        if (expand || alwaysExpand) {
+            return KConfigPrivate::expandString(aValue);
+        }
+
+        return aValue;
+    }
+
+    // The entry readString() and readEntry() read for key
+    static KEntry lookupEntry(const KConfig *config, const QString &group, QAnyStringView key)
+    {
+        return config->d_func()->lookupInternalEntry(group, key, KEntryMap::SearchLocalized);
+    }
+
     static QExplicitlySharedDataPointer<KConfigGroupPrivate> create(KConfigBase *master, const QString &name, bool isImmutable, bool isConst)
     {
         QExplicitlySharedDataPointer<KConfigGroupPrivate> data;
@@ -125,29 +149,92 @@ public:
         }
         return data;
     }
-
-    static QByteArray serializeList(const QList<QByteArray> &list);
-    static QStringList deserializeList(const QString &data);
 };
 
-QByteArray KConfigGroupPrivate::serializeList(const QList<QByteArray> &list)
+// Splits data at the separators that aren't escaped by a backslash, removing the escapes
+static QStringList splitEscaped(QStringView data, char16_t separator, bool keepTrailingEmpty)
 {
-    QByteArray value;
+    QStringList list;
 
-    if (!list.isEmpty()) {
-        auto it = list.cbegin();
-        const auto end = list.cend();
+    if (!data.contains(u'\\')) {
+        // nothing is escaped, a plain split does
+        const QList<QStringView> parts = data.split(separator);
+        list.reserve(parts.size());
+        for (const QStringView part : parts) {
+            list.append(part.toString());
+        }
+        if (!keepTrailingEmpty && list.constLast().isEmpty()) {
+            list.removeLast();
+        }
+        return list;
+    }
+
+    const qsizetype size = data.size();
+    qsizetype start = 0;
+    while (true) {
+        // find the end of the element first, so it can be built in a buffer of the right size
+        qsizetype end = start;
+        bool escaped = false;
+        while (end < size && (escaped || data[end] != separator)) {
+            escaped = !escaped && data[end] == u'\\';
+            ++end;
+        }
 
-        value = QByteArray(*it).replace('\\', QByteArrayLiteral("\\\\")).replace(',', QByteArrayLiteral("\\,"));
+        QString element;
+        element.reserve(end - start);
+        escaped = false;
+        for (qsizetype i = start; i < end; ++i) {
+            if (!escaped && data[i] == u'\\') {
+                escaped = true;
+                continue;
+            }
+            escaped = false;
+            element.append(data[i]);
+        }
 
-        while (++it != end) {
-            // In the loop, so it is not done when there is only one element.
-            // Doing it repeatedly is a pretty cheap operation.
-            value.reserve(4096);
+        if (end == size) {
+            if (keepTrailingEmpty || !element.isEmpty()) {
+                list.append(element);
+            }
+            return list;
+        }
+        list.append(element);
+        start = end + 1;
+    }
+}
 
-            value += ',';
-            value += QByteArray(*it).replace('\\', QByteArrayLiteral("\\\\")).replace(',', QByteArrayLiteral("\\,"));
+// Appends the elements of list to value, escaping backslashes and separator, each followed by separator
+template<typename String, typename Char>
+static void appendEscaped(String &value, const QList<String> &list, Char separator)
+{
+    qsizetype size = 0;
+    for (const String &element : list) {
+        size += element.size() + 1;
+    }
+    value.reserve(size);
+
+    for (const String &element : list) {
+        if (!element.contains(separator) && !element.contains(Char('\\'))) {
+            value += element;
+        } else {
+            for (const auto c : element) {
+                if (c == separator || c == Char('\\')) {
+                    value += Char('\\');
+                }
+                value += c;
+            }
         }
+        value += separator;
+    }
+}
+
+QByteArray KConfigListCodec::serializeList(const QList<QByteArray> &list)
+{
+    QByteArray value;
+
+    if (!list.isEmpty()) {
+        appendEscaped(value, list, ',');
+        value.chop(1);
 
         // To be able to distinguish an empty list from a list with one empty element.
         if (value.isEmpty()) {
@@ -158,7 +245,25 @@ QByteArray KConfigGroupPrivate::serializeList(const QList<QByteArray> &list)
     return value;
 }
 
-QStringList KConfigGroupPrivate::deserializeList(const QString &data)
+QByteArray KConfigListCodec::serializeList(const QStringList &list)
+{
+    if (list.isEmpty()) {
+        return QByteArray();
+    }
+
+    // escaping only involves ASCII, so it can be done before converting everything at once
+    QString value;
+    appendEscaped(value, list, QLatin1Char(','));
+    value.chop(1);
+
+    // To be able to distinguish an empty list from a list with one empty element.
+    if (value.isEmpty()) {
+        return QByteArrayLiteral("\\0");
+    }
+    return value.toUtf8();
+}
+
+QStringList KConfigListCodec::deserializeList(QStringView data)
 {
     if (data.isEmpty()) {
         return QStringList();
@@ -166,29 +271,28 @@ QStringList KConfigGroupPrivate::deserializeList(const QString &data)
     if (data == QLatin1String("\\0")) {
         return QStringList(QString());
     }
-    QStringList value;
-    QString val;
-    val.reserve(data.size());
-    bool quoted = false;
-    for (int p = 0; p < data.length(); p++) {
-        if (quoted) {
-            val += data[p];
-            quoted = false;
-        } else if (data[p].unicode() == '\\') {
-            quoted = true;
-        } else if (data[p].unicode() == ',') {
-            val.squeeze(); // release any unused memory
-            value.append(val);
-            val.clear();
-            val.reserve(data.size() - p);
-        } else {
-            val += data[p];
-        }
-    }
-    value.append(val);
+    return splitEscaped(data, u',', true);
+}
+
+QString KConfigListCodec::serializeXdgList(const QStringList &list)
+{
+    // XXX List serialization being a separate layer from low-level escaping is
+    // probably a bug. No affected entries are defined, though.
+    QString value;
+    appendEscaped(value, list, QLatin1Char(';'));
     return value;
 }
 
+QStringList KConfigListCodec::deserializeXdgList(QStringView data)
+{
+    // XXX List serialization being a separate layer from low-level parsing is
+    // probably a bug. No affected entries are defined, though.
+    if (data.isEmpty()) {
+        return QStringList();
+    }
+    return splitEscaped(data, u';', false);
+}
+
 static QVarLengthArray<int, 8> asIntList(QByteArrayView string)
 {
     int start = 0;
@@ -243,7 +347,7 @@ QVariant KConfigGroup::convertToQVariant(const char *pKey, const QByteArray &val
         return QUuid::fromString(value);
     case QMetaType::QVariantList:
     case QMetaType::QStringList:
-        return KConfigGroupPrivate::deserializeList(QString::fromUtf8(value));
+        return KConfigListCodec::deserializeList(QString::fromUtf8(value));
     case QMetaType::QByteArray:
         return value;
     case QMetaType::Bool: {
@@ -639,48 +743,46 @@ QString KConfigGroup::readEntry(const char *key, const char *aDefault) const
 
 QString KConfigGroup::readEntry(const QString &key, const char *aDefault) const
 {
-    return readEntry(key.toUtf8().constData(), aDefault);
+    return readEntry(key, QString::fromUtf8(aDefault));
 }
 
 QString KConfigGroup::readEntry(const char *key, const QString &aDefault) const
 {
     Q_ASSERT_X(isValid(), "KConfigGroup::readEntry", "accessing an invalid group");
 
-    bool expand = false;
-
-    // read value from the entry map
-    QString aValue = config()->d_func()->lookupData(d->fullName(), key, KEntryMap::SearchLocalized, &expand);
-    if (aValue.isNull()) {
-        aValue = aDefault;
-    }
-
-    if (expand) {
-        return KConfigPrivate::expandString(aValue);
-    }
-
-    return aValue;
+    return d->readString(key, aDefault, false);
 }
 
 QString KConfigGroup::readEntry(const QString &key, const QString &aDefault) const
 {
-    return readEntry(key.toUtf8().constData(), aDefault);
+    Q_ASSERT_X(isValid(), "KConfigGroup::readEntry", "accessing an invalid group");
+
+    // the entry map compares the UTF-16 key to the UTF-8 ones directly
+    return d->readString(key, aDefault, false);
 }
 
 QStringList KConfigGroup::readEntry(const char *key, const QStringList &aDefault) const
 {
     Q_ASSERT_X(isValid(), "KConfigGroup::readEntry", "accessing an invalid group");
 
-    const QString data = readEntry(key, QString());
+    const QString data = d->readString(key, QString(), false);
     if (data.isNull()) {
         return aDefault;
     }
 
-    return KConfigGroupPrivate::deserializeList(data);
+    return KConfigListCodec::deserializeList(data);
 }
 
 QStringList KConfigGroup::readEntry(const QString &key, const QStringList &aDefault) const
 {
-    return readEntry(key.toUtf8().constData(), aDefault);
+    Q_ASSERT_X(isValid(), "KConfigGroup::readEntry", "accessing an invalid group");
+
+    const QString data = d->readString(key, QString(), false);
+    if (data.isNull()) {
+        return aDefault;
+    }
+
+    return KConfigListCodec::deserializeList(data);
 }
 
 QVariant KConfigGroup::readEntry(const char *key, const QVariant &aDefault) const
@@ -714,7 +816,7 @@ QVariantList KConfigGroup::readEntry(const char *key, const QVariantList &aDefau
         return aDefault;
     }
 
-    const auto &list = KConfigGroupPrivate::deserializeList(data);
+    const auto &list = KConfigListCodec::deserializeList(data);
 
     QVariantList value;
     value.reserve(list.count());
@@ -732,78 +834,64 @@ QVariantList KConfigGroup::readEntry(const QString &key, const QVariantList &aDe
 
 QStringList KConfigGroup::readXdgListEntry(const QString &key, const QStringList &aDefault) const
 {
-    return readXdgListEntry(key.toUtf8().constData(), aDefault);
+    Q_ASSERT_X(isValid(), "KConfigGroup::readXdgListEntry", "accessing an invalid group");
+
+    const QString data = d->readString(key, QString(), false);
+    if (data.isNull()) {
+        return aDefault;
+    }
+
+    return KConfigListCodec::deserializeXdgList(data);
 }
 
 QStringList KConfigGroup::readXdgListEntry(const char *key, const QStringList &aDefault) const
 {
     Q_ASSERT_X(isValid(), "KConfigGroup::readXdgListEntry", "accessing an invalid group");
 
-    const QString data = readEntry(key, QString());
+    const QString data = d->readString(key, QString(), false);
     if (data.isNull()) {
         return aDefault;
     }
 
-    QStringList value;
-    QString val;
-    val.reserve(data.size());
-    // XXX List serialization being a separate layer from low-level parsing is
-    // probably a bug. No affected entries are defined, though.
-    bool quoted = false;
-    for (int p = 0; p < data.length(); p++) {
-        if (quoted) {
-            val += data[p];
-            quoted = false;
-        } else if (data[p] == QLatin1Char('\\')) {
-            quoted = true;
-        } else if (data[p] == QLatin1Char(';')) {
-            value.append(val);
-            val.clear();
-            val.reserve(data.size() - p);
-        } else {
-            val += data[p];
-        }
-    }
-    if (!val.isEmpty()) {
-        value.append(val);
-    }
-    return value;
+    return KConfigListCodec::deserializeXdgList(data);
 }
 
 QString KConfigGroup::readPathEntry(const QString &pKey, const QString &aDefault) const
 {
-    return readPathEntry(pKey.toUtf8().constData(), aDefault);
+    Q_ASSERT_X(isValid(), "KConfigGroup::readPathEntry", "accessing an invalid group");
+
+    return d->readString(pKey, aDefault, true);
 }
 
 QString KConfigGroup::readPathEntry(const char *key, const QString &aDefault) const
 {
     Q_ASSERT_X(isValid(), "KConfigGroup::readPathEntry", "accessing an invalid group");
 
-    bool expand = false;
-
-    QString aValue = config()->d_func()->lookupData(d->fullName(), key, KEntryMap::SearchLocalized, &expand);
-    if (aValue.isNull()) {
-        aValue = aDefault;
-    }
-
-    return KConfigPrivate::expandString(aValue);
+    return d->readString(key, aDefault, true);
 }
 
 QStringList KConfigGroup::readPathEntry(const QString &pKey, const QStringList &aDefault) const
 {
-    return readPathEntry(pKey.toUtf8().constData(), aDefault);
+    Q_ASSERT_X(isValid(), "KConfigGroup::readPathEntry", "accessing an invalid group");
+
+    const QString data = d->readString(pKey, QString(), true);
+    if (data.isNull()) {
+        return aDefault;
+    }
+
+    return KConfigListCodec::deserializeList(data);
 }
 
 QStringList KConfigGroup::readPathEntry(const char *key, const QStringList &aDefault) const
 {
     Q_ASSERT_X(isValid(), "KConfigGroup::readPathEntry", "accessing an invalid group");
 
-    const QString data = readPathEntry(key, QString());
+    const QString data = d->readString(key, QString(), true);
     if (data.isNull()) {
         return aDefault;
     }
 
-    return KConfigGroupPrivate::deserializeList(data);
+    return KConfigListCodec::deserializeList(data);
 }
 
 void KConfigGroup::writeEntry(const char *key, const QString &value, WriteConfigFlags flags)
@@ -850,14 +938,7 @@ void KConfigGroup::writeEntry(const char *key, const QStringList &list, WriteCon
     Q_ASSERT_X(isValid(), "KConfigGroup::writeEntry", "accessing an invalid group");
     Q_ASSERT_X(!d->bConst, "KConfigGroup::writeEntry", "writing to a read-only group");
 
-    QList<QByteArray> balist;
-    balist.reserve(list.count());
-
-    for (const QString &entry : list) {
-        balist.append(entry.toUtf8());
-    }
-
-    writeEntry(key, KConfigGroupPrivate::serializeList(balist), flags);
+    writeEntry(key, KConfigListCodec::serializeList(list), flags);
 }
 
 void KConfigGroup::writeEntry(const QString &key, const QStringList &list, WriteConfigFlags flags)
@@ -881,7 +962,7 @@ void KConfigGroup::writeEntry(const char *key, const QVariantList &list, WriteCo
         }
     }
 
-    writeEntry(key, KConfigGroupPrivate::serializeList(data), flags);
+    writeEntry(key, KConfigListCodec::serializeList(data), flags);
 }
 
 void KConfigGroup::writeEntry(const char *key, const QVariant &value, WriteConfigFlags flags)
@@ -1049,17 +1130,7 @@ void KConfigGroup::writeXdgListEntry(const char *key, const QStringList &list, W
     Q_ASSERT_X(isValid(), "KConfigGroup::writeXdgListEntry", "accessing an invalid group");
     Q_ASSERT_X(!d->bConst, "KConfigGroup::writeXdgListEntry", "writing to a read-only group");
 
-    QString value;
-    value.reserve(4096);
-
-    // XXX List serialization being a separate layer from low-level escaping is
-    // probably a bug. No affected entries are defined, though.
-    for (QString val : list) { // clazy:exclude=range-loop
-        val.replace(QLatin1Char('\\'), QLatin1String("\\\\")).replace(QLatin1Char(';'), QLatin1String("\\;"));
-        value += val + QLatin1Char(';');
-    }
-
-    writeEntry(key, value, flags);
+    writeEntry(key, KConfigListCodec::serializeXdgList(list), flags);
 }
 
 void KConfigGroup::writePathEntry(const QString &pKey, const QString &path, WriteConfigFlags pFlags)
@@ -1091,7 +1162,7 @@ void KConfigGroup::writePathEntry(const char *pKey, const QStringList &value, Wr
         list << translatePath(path).toUtf8();
     }
 
-    config()->d_func()->putData(d->fullName(), pKey, KConfigGroupPrivate::serializeList(list), pFlags, true);
+    config()->d_func()->putData(d->fullName(), pKey, KConfigListCodec::serializeList(list), pFlags, true);
 }
 
 void KConfigGroup::deleteEntry(const char *key, WriteConfigFlags flags)
@@ -1282,3 +1353,209 @@ void KConfigGroup::moveValuesTo(KConfigGroup &other, WriteConfigFlags pFlags)
         moveValue(key.toUtf8().constData(), other, pFlags);
     }
 }
+
+class KConfigKeyPrivate : public QSharedData
+{
+public:
+    KConfigKeyPrivate(const KConfigGroup &group, const QString &groupName, const QByteArray &key)
+        : group(group)
+        , groupName(groupName)
+        , key(key)
+    {
+    }
+
+    // Looks the entry up again if the entries of the config changed since the last lookup
+    void update() const
+    {
+        const KConfig *config = group.config();
+        const quint64 configGeneration = KConfigPrivate::entryGeneration(config);
+        if (configGeneration == generation) {
+            return;
+        }
+        generation = configGeneration;
+
+        const KEntry entry = KConfigGroupPrivate::lookupEntry(config, groupName, key);
+        value = entry.bDeleted ? QByteArray() : entry.mValue;
+        expand = entry.bExpand;
+        string = QString();
+        list = QStringList();
+        stringDecoded = false;
+        listDecoded = false;
+    }
+
+    // The value as a string, not expanded, null if there is none
+    const QString &stringValue() const
+    {
+        if (!stringDecoded) {
+            if (!value.isNull()) {
+                string = QString::fromUtf8(value);
+            }
+            stringDecoded = true;
+        }
+        return string;
+    }
+
+    // The value as a list, not expanded
+    const QStringList &listValue() const
+    {
+        if (!listDecoded) {
+            list = KConfigListCodec::deserializeList(stringValue());
+            listDecoded = true;
+        }
+        return list;
+    }
+
+    const KConfigGroup group;
+    const QString groupName;
+    const QByteArray key;
+
+    // result of the last lookup, valid as long as the generation of the config doesn't change
+    mutable quint64 generation = 0;
+    mutable QByteArray value;
+    mutable QString string;
+    mutable QStringList list;
+    mutable bool expand = false;
+    mutable bool stringDecoded = false;
+    mutable bool listDecoded = false;
+};
+
+KConfigKey::KConfigKey() = default;
+
+KConfigKey::KConfigKey(const KConfigGroup &group, const QString &key)
+    : KConfigKey(group, key.toUtf8().constData())
+{
+}
+
+KConfigKey::KConfigKey(const KConfigGroup &group, const char *key)
+{
+    Q_ASSERT_X(group.isValid(), "KConfigKey::KConfigKey", "accessing an invalid group");
+
+    d = new KConfigKeyPrivate(group, group.d->fullName(), key);
+}
+
+KConfigKey::KConfigKey(const KConfigKey &other) = default;
+KConfigKey &KConfigKey::operator=(const KConfigKey &other) = default;
+KConfigKey::KConfigKey(KConfigKey &&other) = default;
+KConfigKey &KConfigKey::operator=(KConfigKey &&other) = default;
+KConfigKey::~KConfigKey() = default;
+
+bool KConfigKey::isValid() const
+{
+    return d.constData() != nullptr;
+}
+
+KConfigGroup KConfigKey::group() const
+{
+    return isValid() ? d->group : KConfigGroup();
+}
+
+QByteArray KConfigKey::key() const
+{
+    return isValid() ? d->key : QByteArray();
+}
+
+bool KConfigKey::exists() const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::exists", "accessing an invalid key");
+
+    d->update();
+    return !d->value.isNull();
+}
+
+QVariant KConfigKey::readEntry(const QVariant &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readEntry", "accessing an invalid key");
+
+    d->update();
+    if (d->value.isNull()) {
+        return aDefault;
+    }
+
+    QVariant value;
+    if (!readEntryGui(d->value, d->key.constData(), aDefault, value)) {
+        return KConfigGroup::convertToQVariant(d->key.constData(), d->value, aDefault);
+    }
+
+    return value;
+}
+
+QString KConfigKey::readEntry(const QString &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readEntry", "accessing an invalid key");
+
+    d->update();
+    if (d->value.isNull()) {
+        return aDefault;
+    }
+
+    if (d->expand) {
+        return KConfigPrivate::expandString(d->stringValue());
+    }
+
+    return d->stringValue();
+}
+
+QString KConfigKey::readEntry(const char *aDefault) const
+{
+    return readEntry(QString::fromUtf8(aDefault));
+}
+
+QStringList KConfigKey::readEntry(const QStringList &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readEntry", "accessing an invalid key");
+
+    d->update();
+    if (d->value.isNull()) {
+        return aDefault;
+    }
+
+    if (d->expand) {
+        return KConfigListCodec::deserializeList(KConfigPrivate::expandString(d->stringValue()));
+    }
+
+    return d->listValue();
+}
+
+QVariantList KConfigKey::readEntry(const QVariantList &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readEntry", "accessing an invalid key");
+
+    d->update();
+    if (d->value.isNull()) {
+        return aDefault;
+    }
+
+    const QStringList list = readEntry(QStringList());
+
+    QVariantList value;
+    value.reserve(list.count());
+    for (const QString &v : list) {
+        value << v;
+    }
+
+    return value;
+}
+
+QStringList KConfigKey::readXdgListEntry(const QStringList &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readXdgListEntry", "accessing an invalid key");
+
+    const QString data = readEntry(QString());
+    if (data.isNull()) {
+        return aDefault;
+    }
+
+    return KConfigListCodec::deserializeXdgList(data);
+}
+
+QString KConfigKey::readPathEntry(const QString &aDefault) const
+{
+    Q_ASSERT_X(isValid(), "KConfigKey::readPathEntry", "accessing an invalid key");
+
+    d->update();
+    if (d->value.isNull()) {
+        return KConfigPrivate::expandString(aDefault);
+    }
+
+    return KConfigPrivate::expandString(d->stringValue());
+}
@@ -16,11 +16,13 @@
 #include <kconfigcore_export.h>
 
 #include <QExplicitlySharedDataPointer>
+#include <QSharedDataPointer>
 #include <QStringList>
 #include <QVariant>
 
 class KConfig;
 class KConfigGroupPrivate;
+class KConfigKeyPrivate;
 class KSharedConfig;
 
 /*!
@@ -623,6 +625,7 @@ private:
     QExplicitlySharedDataPointer<KConfigGroupPrivate> d;
 
     friend class KConfigGroupPrivate;
+    friend class KConfigKey;
 
     /*!
      * \internal
@@ -649,6 +652,134 @@ private:
 
 Q_DECLARE_TYPEINFO(KConfigGroup, Q_RELOCATABLE_TYPE);
 
+/*!
+ * \class KConfigKey
+ * \inmodule KConfigCore
+ *
+ * \brief A handle for reading one entry of a KConfigGroup repeatedly.
+ *
+ * Every KConfigGroup::readEntry() call looks the key up in the entries of
+ * the config again. Code reading the same entry over and over, e.g. while
+ * painting or in a loop over many items, can create a KConfigKey for it once
+ * instead. The handle remembers the result of its last lookup, and only looks
+ * the entry up again after the entries of the config changed, i.e. after a
+ * write, a revert, a group deletion or KConfig::reparseConfiguration().
+ * Reading a string or string list entry that didn't change doesn't allocate.
+ *
+ * \code
+ * const KConfigKey fontKey(group, QStringLiteral("Font"));
+ * for (Item &item : items) {
+ *     item.setFont(fontKey.readEntry(QFont()));
+ * }
+ * \endcode
+ *
+ * Entries are written through the group as usual. Like the group it was
+ * created from, a KConfigKey must not be used after its config was destroyed.
+ *
+ * \since 6.30
+ * \sa KConfigGroup::readEntry()
+ */
+class KCONFIGCORE_EXPORT KConfigKey
+{
+public:
+    /*!
+     * Constructs an invalid key.
+     */
+    KConfigKey();
+
+    /*!
+     * Constructs a handle for the entry \a key of \a group, which must be valid.
+     */
+    KConfigKey(const KConfigGroup &group, const QString &key);
+
+    /*!
+     * \overload KConfigKey(const KConfigGroup&, const QString&)
+     * The \a key will be encoded in UTF-8.
+     */
+    KConfigKey(const KConfigGroup &group, const char *key);
+
+    KConfigKey(const KConfigKey &other);
+    KConfigKey &operator=(const KConfigKey &other);
+    KConfigKey(KConfigKey &&other);
+    KConfigKey &operator=(KConfigKey &&other);
+    ~KConfigKey();
+
+    /*!
+     * Returns whether this handle was constructed from a group and key.
+     */
+    bool isValid() const;
+
+    /*!
+     * Returns the group of the entry.
+     */
+    KConfigGroup group() const;
+
+    /*!
+     * Returns the UTF-8 encoded key of the entry.
+     */
+    QByteArray key() const;
+
+    /*!
+     * Returns whether the entry has a value.
+     * \sa KConfigGroup::hasKey()
+     */
+    bool exists() const;
+
+    /*!
+     * Returns the value of the entry, or \a aDefault if it has none.
+     * \sa KConfigGroup::readEntry<T>(const char*, const T&) const
+     */
+    template<typename T>
+    T readEntry(const T &aDefault) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    template<typename T>
+    QList<T> readEntry(const QList<T> &aDefault) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    QVariant readEntry(const QVariant &aDefault) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    QString readEntry(const QString &aDefault) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    QString readEntry(const char *aDefault = nullptr) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    QStringList readEntry(const QStringList &aDefault) const;
+
+    /*!
+     * \overload readEntry<T>(const T&) const
+     */
+    QVariantList readEntry(const QVariantList &aDefault) const;
+
+    /*!
+     * Returns the value of the entry as a list in the format of the
+     * Desktop Entry Specification, or \a aDefault if it has none.
+     * \sa KConfigGroup::readXdgListEntry()
+     */
+    QStringList readXdgListEntry(const QStringList &aDefault = QStringList()) const;
+
+    /*!
+     * Returns the value of the entry as a path, or \a aDefault if it has none.
+     * \sa KConfigGroup::readPathEntry()
+     */
+    QString readPathEntry(const QString &aDefault) const;
+
+private:
+    QSharedDataPointer<KConfigKeyPrivate> d;
+};
+
 #define KCONFIGGROUP_ENUMERATOR_ERROR(ENUM) "The Qt MetaObject system does not seem to know about \"" ENUM "\" please use Q_ENUM or Q_FLAG to register it."
 
 /*!
@@ -746,6 +877,34 @@ QList<T> KConfigGroup::readEntry(const char *key, const QList<T> &defaultValue)
     return list;
 }
 
+template<typename T>
+T KConfigKey::readEntry(const T &aDefault) const
+{
+    KConfigConversionCheck::to_QVariant<T>();
+    return qvariant_cast<T>(readEntry(QVariant::fromValue(aDefault)));
+}
+
+template<typename T>
+QList<T> KConfigKey::readEntry(const QList<T> &aDefault) const
+{
+    KConfigConversionCheck::to_QVariant<T>();
+    KConfigConversionCheck::to_QString<T>();
+
+    QVariantList data;
+    for (const T &value : aDefault) {
+        data.append(QVariant::fromValue(value));
+    }
+
+    QList<T> list;
+    const QVariantList variantList = readEntry(data);
+    for (const QVariant &value : variantList) {
+        Q_ASSERT(value.canConvert<T>());
+        list.append(qvariant_cast<T>(value));
+    }
+
+    return list;
+}
+
 template<typename Rep, typename Period>
 std::chrono::duration<Rep, Period> KConfigGroup::readEntry(const char *key, std::chrono::duration<Rep, Period> value) const
 {
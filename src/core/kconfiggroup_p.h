@@ -23,4 +23,19 @@ struct KConfigGroupGui {
 
 extern KCONFIGCORE_EXPORT KConfigGroupGui _kde_internal_KConfigGroupGui;
 
+/*
+ * Encoding of list entries. Elements are separated by ',' for KConfigGroup::writeEntry(),
+ * and terminated by ';' for KConfigGroup::writeXdgListEntry(). Backslashes and
+ * separators in elements are escaped with a backslash.
+ */
+namespace KConfigListCodec
+{
+QByteArray serializeList(const QList<QByteArray> &list);
+QByteArray serializeList(const QStringList &list);
+QStringList deserializeList(QStringView data);
+
+QString serializeXdgList(const QStringList &list);
+QStringList deserializeXdgList(QStringView data);
+}
+
 #endif
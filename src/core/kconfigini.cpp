@@ -12,6 +12,21 @@
 #include "kconfig_core_log_settings.h"
 #include "kconfigdata_p.h"
 #include "kconfiginibackendreader_p.h"
+#include "kconfigtracing_p.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+
+#include <atomic>
+
+#ifdef KCONFIG_USE_UNSYNCED_RENAME
+#include <QMutex>
+#include <QSet>
+#include <QWaitCondition>
+
+#include <thread>
+#include <utility>
+#endif
 
 using namespace Qt::StringLiterals;
 
@@ -25,11 +40,190 @@ QString warningProlog(const KConfigIniBackendAbstractDevice *device, int line)
     // This avoids a wrong substitution if the fileName itself contains %1
     return u"KConfigIni: In file %2, line %1:"_s.arg(line).arg(device->id());
 }
+
+// Whether key is like "Name[fr]" for a locale other than the current one, checked on the raw bytes.
+// This repeats the locale rules of the full parser below for the common case, KConfigTest::testForeignTranslations
+// checks that both agree.
+std::atomic<bool> s_foreignTranslationRejectEnabled{true};
+
+bool isForeignTranslation(QByteArrayView key, QByteArrayView currentLocale, QByteArrayView currentLanguage)
+{
+    if (!key.endsWith(']')) {
+        return false;
+    }
+    // keys with options or several brackets are left to the full parser and its error checks
+    const qsizetype start = key.indexOf('[');
+    if (start <= 0 || key.lastIndexOf('[') != start || key.at(start + 1) == '$') {
+        return false;
+    }
+    const QByteArrayView locale = key.sliced(start + 1, key.size() - start - 2);
+    if (locale.isEmpty() || locale == currentLocale || locale == currentLanguage) {
+        return false;
+    }
+    // backward compatibility. C == en_US
+    return locale.at(0) != 'C' || currentLocale != "en_US";
+}
+
+// Shares the data of equal keys and short values read by one parseConfig() call, so that
+// e.g. all the "Enabled=true" entries of a file don't each allocate their own "Enabled" and "true".
+// The most common values point to static data and don't need an allocation at all.
+// Entries keep QByteArray values, which have no inline storage for short data in Qt 6, and values
+// pointing into an arena of the KConfig with QByteArray::fromRawData() would leave the copies that
+// readEntry() hands out dangling once the KConfig is reparsed or destroyed, so sharing is what's left.
+std::atomic<bool> s_sharedDataPoolEnabled{true};
+
+class SharedDataPool
+{
+public:
+    SharedDataPool()
+        : m_enabled(s_sharedDataPoolEnabled.load(std::memory_order_relaxed))
+    {
+        if (!m_enabled) {
+            return;
+        }
+        for (const QByteArray &value : {QByteArrayLiteral("true"), QByteArrayLiteral("false"), QByteArrayLiteral("0"), QByteArrayLiteral("1")}) {
+            m_data.insert(value, value);
+        }
+    }
+
+    QByteArray get(QByteArrayView data)
+    {
+        // long data is unlikely to repeat, and empty or null data doesn't allocate anyway
+        if (!m_enabled || data.isEmpty() || data.size() > s_maxSharedSize) {
+            return data.toByteArray();
+        }
+
+        const auto it = m_data.constFind(data);
+        if (it != m_data.cend()) {
+            return *it;
+        }
+        const QByteArray copy = data.toByteArray();
+        // the key views the buffer of the stored copy, which stays alive as long as the pool
+        m_data.insert(copy, copy);
+        return copy;
+    }
+
+private:
+    static constexpr qsizetype s_maxSharedSize = 64;
+    const bool m_enabled;
+    QHash<QByteArrayView, QByteArray> m_data;
+};
 } // anonymous namespace
 
+namespace KConfigIniBackendInternal
+{
+/*
+ * Lets the benchmark compare parsing with and without sharing the data of entries
+ */
+KCONFIGCORE_EXPORT void setSharedDataPoolEnabled(bool enabled)
+{
+    s_sharedDataPoolEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+/*
+ * Lets the benchmark and unit tests compare parsing with and without dropping
+ * the translations for other locales before parsing their keys
+ */
+KCONFIGCORE_EXPORT void setForeignTranslationRejectEnabled(bool enabled)
+{
+    s_foreignTranslationRejectEnabled.store(enabled, std::memory_order_relaxed);
+}
+}
+
 KConfigIniBackend::KConfigIniBackend(std::unique_ptr<KConfigIniBackendAbstractDevice> deviceInterface)
     : mDeviceInterface(std::move(deviceInterface)) { };
 
+#ifdef KCONFIG_USE_UNSYNCED_RENAME
+namespace
+{
+// Flushes the files written with KConfig::DeferredDurability to disk on a thread of its own.
+// It waits a second after the first file comes in, so that the files written meanwhile are
+// flushed in the same round, and flushes what is left when the process exits.
+class DeferredFileSync
+{
+public:
+    ~DeferredFileSync()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_quit = true;
+            m_condition.wakeOne();
+        }
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void add(const QString &filePath)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.insert(filePath);
+        if (!m_thread.joinable()) {
+            m_thread = std::thread(&DeferredFileSync::run, this);
+        }
+        m_condition.wakeOne();
+    }
+
+private:
+    void run()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (true) {
+            while (m_pending.isEmpty() && !m_quit) {
+                m_condition.wait(&m_mutex);
+            }
+            const QDeadlineTimer batchEnd(std::chrono::seconds{1});
+            while (!m_quit && !batchEnd.hasExpired()) {
+                m_condition.wait(&m_mutex, batchEnd);
+            }
+
+            const QSet<QString> files = std::exchange(m_pending, {});
+            const bool quit = m_quit;
+            locker.unlock();
+            QSet<QString> directories;
+            for (const QString &file : files) {
+                syncToDisk(file, O_RDONLY);
+                directories.insert(QFileInfo(file).absolutePath());
+            }
+            // so that the renames of the files are on disk as well
+            for (const QString &directory : std::as_const(directories)) {
+                syncToDisk(directory, O_RDONLY | O_DIRECTORY);
+            }
+            locker.relock();
+
+            if (quit && m_pending.isEmpty()) {
+                return;
+            }
+        }
+    }
+
+    static void syncToDisk(const QString &path, int flags)
+    {
+        const int fd = ::open(QFile::encodeName(path).constData(), flags | O_CLOEXEC);
+        if (fd < 0) {
+            return; // removed meanwhile
+        }
+        ::fsync(fd);
+        ::close(fd);
+    }
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QSet<QString> m_pending;
+    bool m_quit = false;
+    std::thread m_thread;
+};
+Q_GLOBAL_STATIC(DeferredFileSync, s_deferredFileSync)
+} // namespace
+
+void kconfigDeferFileSync(const QString &filePath)
+{
+    if (DeferredFileSync *deferredSync = s_deferredFileSync()) {
+        deferredSync->add(filePath);
+    }
+}
+#endif
+
 KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &currentLocale, KEntryMap &entryMap, ParseOptions options)
 {
     return parseConfig(currentLocale, entryMap, options, false);
@@ -43,6 +237,29 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
         return ParseOk;
     }
 
+    const bool tracing = KConfigTracing::isEnabled();
+
+    // Don't read a file while another process rewrites it in place, the merging parse of a writer holds the exclusive lock already.
+    // Only files of other users are written in place, files of our own are replaced atomically and readLockFile() doesn't lock them,
+    // so that parses, often on the GUI thread, don't wait for writers e.g. of kdeglobals on a theme switch.
+    // If the writer takes too long, read anyway, like without the lock.
+    std::unique_ptr<AbstractLockFile> readLock;
+    if (!merging) {
+        constexpr std::chrono::milliseconds readLockTimeout = std::chrono::seconds{5};
+        readLock = mDeviceInterface->readLockFile();
+
+        QElapsedTimer lockTimer;
+        if (tracing) {
+            lockTimer.start();
+        }
+        if (!readLock->tryLock(readLockTimeout)) {
+            qCWarning(KCONFIG_CORE_LOG) << "Failed to lock file" << readLock->fileName() << "for reading with error" << int(readLock->error());
+        }
+        if (tracing && !readLock->fileName().isEmpty()) {
+            KConfigTracingInternal::recordLockWait(mDeviceInterface->id(), lockTimer.nsecsElapsed(), KConfigTracingInternal::SharedLock);
+        }
+    }
+
     auto openResult = mDeviceInterface->open();
     if (openResult.shouldHaveDevice && !openResult.device) {
         return ParseOpenError;
@@ -56,6 +273,13 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
         return ParseOk;
     }
 
+    QElapsedTimer parseTimer;
+    if (tracing) {
+        parseTimer.start();
+    }
+    const auto initialEntryCount = entryMap.size();
+    quint64 bytesRead = 0;
+
     QList<QString> immutableGroups;
 
     bool fileOptionImmutable = false;
@@ -66,8 +290,11 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
 
     const int langIdx = currentLocale.indexOf('_');
     const QByteArray currentLanguage = langIdx >= 0 ? currentLocale.left(langIdx) : currentLocale;
+    // merging has to keep all translations
+    const bool rejectForeignTranslations = !merging && s_foreignTranslationRejectEnabled.load(std::memory_order_relaxed);
 
     QString currentGroup = u"<default>"_s;
+    SharedDataPool sharedData;
     bool bDefault = options & ParseDefaults;
     bool allowExecutableValues = options & ParseExpansions;
 
@@ -88,6 +315,7 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
             qCWarning(KCONFIG_CORE_LOG) << "Couldn't find a single line in " << mDeviceInterface->id() << " after reading" << (maximumSizeWithoutNewLine)
                                         << "bytes.";
         }
+        bytesRead += buffer.size();
         QByteArrayView line = buffer;
         line = line.trimmed();
         ++lineNo;
@@ -154,8 +382,14 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
                 continue; // skip entry
             }
 
-            QByteArrayView aKey;
             int eqpos = line.indexOf('=');
+            // Translated files carry dozens of translations per key, drop the ones for other
+            // locales before doing anything else with them.
+            if (rejectForeignTranslations && eqpos > 0 && isForeignTranslation(line.first(eqpos).trimmed(), currentLocale, currentLanguage)) {
+                continue;
+            }
+
+            QByteArrayView aKey;
             if (eqpos < 0) {
                 aKey = line;
                 line = {};
@@ -204,7 +438,7 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
                             }
                             aKey.truncate(start);
                             printableToString(aKey, mDeviceInterface.get(), lineNo);
-                            entryMap.setEntry(currentGroup, aKey.toByteArray(), QByteArray(), entryOptions);
+                            entryMap.setEntry(currentGroup, sharedData.get(aKey), QByteArray(), entryOptions);
                             goto next_line;
                         default:
                             break;
@@ -261,15 +495,19 @@ KConfigIniBackend::ParseInfo KConfigIniBackend::parseConfig(const QByteArray &cu
                 rawKey.reserve(aKey.length() + locale.length() + 2);
                 rawKey.append(aKey);
                 rawKey.append('[').append(locale).append(']');
-                entryMap.setEntry(currentGroup, rawKey, line.toByteArray(), entryOptions);
+                entryMap.setEntry(currentGroup, rawKey, sharedData.get(line), entryOptions);
             } else {
-                entryMap.setEntry(currentGroup, aKey.toByteArray(), line.toByteArray(), entryOptions);
+                entryMap.setEntry(currentGroup, sharedData.get(aKey), sharedData.get(line), entryOptions);
             }
         }
     next_line:
         continue;
     }
 
+    if (tracing) {
+        KConfigTracingInternal::recordParse(mDeviceInterface->id(), bytesRead, parseTimer.nsecsElapsed(), entryMap.size() - initialEntryCount);
+    }
+
     if (errorCount > MAX_ERRORS) {
         qCWarning(KCONFIG_CORE_LOG) << "Too many errors in file" << mDeviceInterface->id();
         return ParseOpenError;
@@ -395,11 +633,130 @@ void KConfigIniBackend::writeEntries(const QByteArray &locale, QIODevice &file,
     writeEntries(locale, file, map, false, false, firstEntry);
 }
 
+QList<KConfigIniBackend::GroupEntry>
+KConfigIniBackend::parseGroupEntries(const QByteArray &currentLocale, QByteArrayView group, const QList<QByteArray> &keys, bool *groupFound)
+{
+    QList<GroupEntry> entries(keys.size());
+    if (groupFound) {
+        *groupFound = false;
+    }
+
+    auto openResult = mDeviceInterface->open();
+    auto file = std::move(openResult.device);
+    if (!file) {
+        return entries;
+    }
+    // .desktop files are small, reading them at once beats reading line by line
+    QByteArray contents = file->readAll();
+
+    const int langIdx = currentLocale.indexOf('_');
+    const QByteArray currentLanguage = langIdx >= 0 ? currentLocale.left(langIdx) : currentLocale;
+
+    // how well the value found so far matches the locale, like the lookup of localized entries in KEntryMap
+    enum Match {
+        NoMatch,
+        Untranslated,
+        Language,
+        Country,
+    };
+    QList<Match> matches(keys.size(), NoMatch);
+
+    bool inGroup = false;
+    int lineNo = 0;
+    for (QByteArrayView rest = contents; !rest.isEmpty();) {
+        const qsizetype eol = rest.indexOf('\n');
+        QByteArrayView line = eol < 0 ? rest : rest.first(eol);
+        rest = eol < 0 ? QByteArrayView() : rest.sliced(eol + 1);
+        line = line.trimmed();
+        ++lineNo;
+
+        if (line.isEmpty() || line.at(0) == '#') {
+            continue;
+        }
+
+        if (line.at(0) == '[') {
+            if (inGroup) {
+                break; // the group ended, nothing of interest follows
+            }
+            // the group header, optionally followed by [$i]
+            inGroup = line.size() > group.size() + 1 && line.sliced(1, group.size()) == group && line.at(group.size() + 1) == ']'
+                && (line.size() == group.size() + 2 || line.sliced(group.size() + 2) == "[$i]");
+            if (inGroup && groupFound) {
+                *groupFound = true;
+            }
+            continue;
+        }
+        if (!inGroup) {
+            continue;
+        }
+
+        const qsizetype eqpos = line.indexOf('=');
+        if (eqpos < 0) {
+            continue;
+        }
+        QByteArrayView aKey = line.first(eqpos).trimmed();
+        QByteArrayView value = line.sliced(eqpos + 1).trimmed();
+
+        bool expand = false;
+        QByteArrayView locale;
+        qsizetype start;
+        while ((start = aKey.lastIndexOf('[')) > 0) {
+            const qsizetype end = aKey.indexOf(']', start);
+            if (end < 0) {
+                break;
+            }
+            if (end > start + 1 && aKey.at(start + 1) == '$') {
+                const QByteArrayView options = aKey.sliced(start + 2, end - start - 2);
+                if (options.contains('d')) {
+                    goto next_line; // deleted entry
+                }
+                expand = expand || options.contains('e');
+            } else {
+                locale = aKey.sliced(start + 1, end - start - 1);
+            }
+            aKey.truncate(start);
+        }
+
+        {
+            const qsizetype keyIndex = keys.indexOf(aKey);
+            if (keyIndex < 0) {
+                continue;
+            }
+
+            Match match = Untranslated;
+            if (!locale.isEmpty()) {
+                if (locale == currentLocale) {
+                    match = locale.contains('_') ? Country : Language;
+                } else if (locale == currentLanguage || (locale.at(0) == 'C' && currentLocale == "en_US")) {
+                    match = Language;
+                } else {
+                    continue; // some other translation
+                }
+            }
+            if (match < matches.at(keyIndex)) {
+                continue;
+            }
+            matches[keyIndex] = match;
+
+            printableToString(value, mDeviceInterface.get(), lineNo);
+            GroupEntry &entry = entries[keyIndex];
+            entry.value = value.toByteArray();
+            entry.found = true;
+            entry.expand = expand;
+        }
+    next_line:
+        continue;
+    }
+
+    return entries;
+}
+
 bool KConfigIniBackend::writeConfig(const QByteArray &locale, KEntryMap &entryMap, WriteOptions options)
 {
     Q_ASSERT(mDeviceInterface->isDeviceReadable());
 
-    KEntryMap writeMap;
+    // only lives for this write, so dropping its nodes at once is all the freeing it needs
+    KEntryMap writeMap(KEntryMap::ArenaAllocation);
     const bool bGlobal = options & WriteGlobal;
 
     // First, reparse the file on disk, to merge our changes with the ones done by other apps
@@ -444,9 +801,22 @@ bool KConfigIniBackend::writeConfig(const QByteArray &locale, KEntryMap &entryMa
         }
     }
 
-    return mDeviceInterface->writeToDevice([this, &locale, &writeMap](auto &device) {
-        writeEntries(locale, device, writeMap);
-    });
+    QElapsedTimer writeTimer;
+    const bool tracing = KConfigTracing::isEnabled();
+    if (tracing) {
+        writeTimer.start();
+    }
+
+    const bool written = mDeviceInterface->writeToDevice(
+        [this, &locale, &writeMap](auto &device) {
+            writeEntries(locale, device, writeMap);
+        },
+        mDurability);
+
+    if (tracing) {
+        KConfigTracingInternal::recordWrite(mDeviceInterface->id(), writeTimer.nsecsElapsed());
+    }
+    return written;
 }
 
 bool KConfigIniBackend::isWritable() const
@@ -484,14 +854,26 @@ bool KConfigIniBackend::lock()
     // Default staleLockTime is 30 seconds. Set it lower since KConfig is not expected to hold the
     // lock for long. The tryLockTimeout is set to staleLockTime*2+buffer, to cover the case when
     // the file modification date is in the future, and the fallback to prevent blocking forever.
+    // Where the lock is taken with flock() there are no stale locks, the timeout only prevents
+    // blocking forever on a process that doesn't release it.
     constexpr std::chrono::milliseconds tryLockTimeout = std::chrono::seconds{45};
 
     lockFile = mDeviceInterface->lockFile();
 
+    QElapsedTimer lockTimer;
+    const bool tracing = KConfigTracing::isEnabled();
+    if (tracing) {
+        lockTimer.start();
+    }
+
     if (!lockFile->tryLock(tryLockTimeout)) {
         qCWarning(KCONFIG_CORE_LOG) << "Failed to lock file" << lockFile->fileName() << "with error" << int(lockFile->error());
     }
 
+    if (tracing) {
+        KConfigTracingInternal::recordLockWait(mDeviceInterface->id(), lockTimer.nsecsElapsed());
+    }
+
     return lockFile->isLocked();
 }
 
@@ -801,11 +1183,26 @@ void KConfigIniBackend::setPrimaryGroup(const QString &group)
     mPrimaryGroup = group;
 }
 
+void KConfigIniBackend::setDurability(KConfig::Durability durability)
+{
+    mDurability = durability;
+}
+
+KConfig::Durability KConfigIniBackend::durability() const
+{
+    return mDurability;
+}
+
 bool KConfigIniBackend::hasOpenableDeviceInterface() const
 {
     return mDeviceInterface->isDeviceReadable();
 }
 
+QString KConfigIniBackend::deviceId() const
+{
+    return mDeviceInterface->id();
+}
+
 QString KConfigIniBackend::backingDevicePath() const
 {
     if (dynamic_cast<KConfigIniBackendPathDevice *>(mDeviceInterface.get())) {
@@ -16,6 +16,7 @@
 #include <QMutex>
 #include <QSharedData>
 
+#include <kconfig.h>
 #include <kconfigbase.h>
 #include <kconfigcore_export.h>
 
@@ -66,9 +67,30 @@ public:
     ParseInfo parseConfig(const QByteArray &locale, KEntryMap &entryMap, ParseOptions options, bool merging);
     bool writeConfig(const QByteArray &locale, KEntryMap &entryMap, WriteOptions options);
 
+    /* A value read by parseGroupEntries() */
+    struct GroupEntry {
+        QByteArray value;
+        bool found = false;
+        bool expand = false; // marked with [$e]
+    };
+
+    /*
+     * Reads only the given keys of one group, with the translation for locale if
+     * there is one, and stops reading at the end of that group. Meant for reading
+     * a few keys of many files, e.g. the [Desktop Entry] group of .desktop files.
+     *
+     * Returns the entries in the order of keys. groupFound tells whether the file
+     * has the group at all.
+     */
+    QList<GroupEntry> parseGroupEntries(const QByteArray &locale, QByteArrayView group, const QList<QByteArray> &keys, bool *groupFound = nullptr);
+
     /** Group that will always be the first in the ini file, to serve as a magic file signature */
     void setPrimaryGroup(const QString &group);
 
+    /* How durably writeConfig() writes the file */
+    void setDurability(KConfig::Durability durability);
+    KConfig::Durability durability() const;
+
     bool isWritable() const;
     QString nonWritableErrorMessage() const;
     KConfigBase::AccessMode accessMode() const;
@@ -82,6 +104,8 @@ public:
     }
     [[nodiscard]] bool hasOpenableDeviceInterface() const;
     [[nodiscard]] QString backingDevicePath() const;
+    // Path for path based devices, a pseudo name for all others
+    [[nodiscard]] QString deviceId() const;
 
 private:
     enum StringType {
@@ -100,6 +124,7 @@ private:
 
     std::unique_ptr<KConfigIniBackendAbstractDevice> mDeviceInterface;
     QString mPrimaryGroup;
+    KConfig::Durability mDurability = KConfig::FullDurability;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(KConfigIniBackend::ParseOptions)
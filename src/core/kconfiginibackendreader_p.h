@@ -6,27 +6,48 @@
 
 #pragma once
 
+#include <QDeadlineTimer>
 #include <QDir>
 #include <QFile>
 #include <QLockFile>
 #include <QSaveFile>
+#include <QTemporaryFile>
 
 #ifdef Q_OS_ANDROID
 #include <QStandardPaths>
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <qtpreprocessorsupport.h>
+#include <thread>
 
 #ifndef Q_OS_WIN
 #include <unistd.h> // getuid
 #endif
 #include <sys/types.h> // uid_t
 
+#if defined(Q_OS_UNIX) && !defined(Q_OS_ANDROID)
+#define KCONFIG_USE_FLOCK
+#define KCONFIG_USE_UNSYNCED_RENAME
+#include <cerrno>
+#include <cstdio> // rename
+#include <fcntl.h>
+#include <sys/file.h> // flock
+#include <sys/stat.h>
+#endif
+
+#include "kconfig.h"
 #include "kconfig_core_log_settings.h"
 
 using namespace Qt::StringLiterals;
 
+#ifdef KCONFIG_USE_UNSYNCED_RENAME
+// Flushes filePath to disk in the background, together with the other files passed
+// within about a second. Defined in kconfigini.cpp.
+void kconfigDeferFileSync(const QString &filePath);
+#endif
+
 // Wraps a QLockFile to allow no-op locking when locking is not supported (e.g. QIODevice based backends).
 class AbstractLockFile
 {
@@ -51,9 +72,21 @@ public:
         m_lockFile->setStaleLockTime(std::chrono::seconds{20});
     }
 
+    // Waits in short steps instead of the growing sleeps of QLockFile::tryLock(), so that many processes
+    // writing the same file at once (e.g. kdeglobals on a theme switch) get their turn soon after the
+    // previous one is done.
     [[nodiscard]] bool tryLock(std::chrono::milliseconds timeout) override
     {
-        return m_lockFile->tryLock(timeout);
+        const QDeadlineTimer deadline(timeout);
+        std::chrono::nanoseconds sleepTime = std::chrono::milliseconds{1};
+        while (!m_lockFile->tryLock(std::chrono::milliseconds::zero())) {
+            if (m_lockFile->error() != QLockFile::LockFailedError || deadline.hasExpired()) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::min(sleepTime, deadline.remainingTimeAsDuration()));
+            sleepTime = std::min<std::chrono::nanoseconds>(sleepTime * 2, std::chrono::milliseconds{16});
+        }
+        return true;
     }
 
     void unlock() override
@@ -79,6 +112,112 @@ private:
     std::unique_ptr<QLockFile> m_lockFile;
 };
 
+#ifdef KCONFIG_USE_FLOCK
+// Takes a shared flock() on the QLockFile of a writer, for reading while no writer is active.
+// On Unix QLockFile holds an exclusive flock() on its file, so this waits for a writer, but
+// readers don't wait for each other, and the kernel releases the lock of a writer that died.
+// Readers never create the lock file, which only exists while a writer holds it or after it
+// crashed, so QLockFile of any version of KConfig still decides alone who gets to write.
+class FlockLockFile : public AbstractLockFile
+{
+public:
+    explicit FlockLockFile(const QString &fileName)
+        : m_fileName(fileName)
+    {
+    }
+
+    ~FlockLockFile() override
+    {
+        unlock();
+    }
+
+    // This also returns true, without locking, when there is no lock file
+    [[nodiscard]] bool tryLock(std::chrono::milliseconds timeout) override
+    {
+        if (m_fd >= 0) {
+            return true;
+        }
+
+        const QByteArray path = QFile::encodeName(m_fileName);
+        const QDeadlineTimer deadline(timeout);
+        std::chrono::nanoseconds sleepTime = std::chrono::milliseconds{1};
+        m_error = QLockFile::NoError;
+
+        int fd = -1;
+        while (true) {
+            if (fd < 0) {
+                fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    if (errno == ENOENT) {
+                        return true; // nobody is writing
+                    }
+                    m_error = errno == EACCES ? QLockFile::PermissionError : QLockFile::UnknownError;
+                    return false;
+                }
+            }
+
+            if (::flock(fd, LOCK_SH | LOCK_NB) == 0) {
+                if (isCurrentFile(fd, path)) {
+                    m_fd = fd;
+                    return true;
+                }
+                // the file was replaced while we waited, wait for the writer holding the new one
+                ::close(fd);
+                fd = -1;
+                continue;
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EWOULDBLOCK || deadline.hasExpired()) {
+                m_error = errno == EWOULDBLOCK ? QLockFile::LockFailedError : QLockFile::UnknownError;
+                ::close(fd);
+                return false;
+            }
+            std::this_thread::sleep_for(std::min(sleepTime, deadline.remainingTimeAsDuration()));
+            sleepTime = std::min<std::chrono::nanoseconds>(sleepTime * 2, std::chrono::milliseconds{16});
+        }
+    }
+
+    void unlock() override
+    {
+        if (m_fd < 0) {
+            return;
+        }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    [[nodiscard]] bool isLocked() const override
+    {
+        return m_fd >= 0;
+    }
+
+    [[nodiscard]] QString fileName() const override
+    {
+        return m_fileName;
+    }
+
+    [[nodiscard]] QLockFile::LockError error() const override
+    {
+        return m_error;
+    }
+
+private:
+    static bool isCurrentFile(int fd, const QByteArray &path)
+    {
+        struct stat locked;
+        struct stat current;
+        return ::fstat(fd, &locked) == 0 && ::stat(path.constData(), &current) == 0 && locked.st_dev == current.st_dev && locked.st_ino == current.st_ino;
+    }
+
+    const QString m_fileName;
+    int m_fd = -1;
+    QLockFile::LockError m_error = QLockFile::NoError;
+};
+#endif
+
 class FakeLockFile : public AbstractLockFile
 {
 public:
@@ -128,9 +267,11 @@ public:
     [[nodiscard]] virtual QString id() const = 0;
     [[nodiscard]] virtual bool isDeviceReadable() const = 0;
     [[nodiscard]] virtual bool canWriteToDevice() const = 0;
-    [[nodiscard]] virtual bool writeToDevice(const std::function<void(QIODevice &)> &write) = 0;
+    [[nodiscard]] virtual bool writeToDevice(const std::function<void(QIODevice &)> &write, KConfig::Durability durability) = 0;
     [[nodiscard]] virtual OpenResult open() = 0;
     [[nodiscard]] virtual std::unique_ptr<AbstractLockFile> lockFile() = 0;
+    // Lock held while reading, shared with other readers but not with the lockFile() of a writer
+    [[nodiscard]] virtual std::unique_ptr<AbstractLockFile> readLockFile() = 0;
     virtual void createEnclosingEntity() = 0;
     virtual void setFilePath(const QString &path) = 0;
 };
@@ -153,9 +294,10 @@ public:
         return false;
     }
 
-    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write) override
+    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write, KConfig::Durability durability) override
     {
         Q_UNUSED(write)
+        Q_UNUSED(durability)
         return false;
     }
 
@@ -169,6 +311,11 @@ public:
         return std::make_unique<FakeLockFile>();
     }
 
+    [[nodiscard]] std::unique_ptr<AbstractLockFile> readLockFile() override
+    {
+        return std::make_unique<FakeLockFile>();
+    }
+
     void createEnclosingEntity() override
     {
     }
@@ -222,7 +369,7 @@ public:
         return dir.isDir() && dir.isWritable();
     }
 
-    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write) override
+    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write, KConfig::Durability durability) override
     {
         // check if file exists
         QFile::Permissions fileMode = filePath().startsWith(u"/etc/xdg/"_s) ? QFile::ReadUser | QFile::WriteUser | QFile::ReadGroup | QFile::ReadOther //
@@ -247,6 +394,14 @@ public:
 #endif
         }
 
+#ifdef KCONFIG_USE_UNSYNCED_RENAME
+        if (createNew && durability != KConfig::FullDurability) {
+            return writeWithoutSync(write, fileMode, fi.exists(), durability == KConfig::DeferredDurability);
+        }
+#else
+        Q_UNUSED(durability)
+#endif
+
         if (createNew) {
             QSaveFile file(filePath());
             if (!file.open(QIODevice::WriteOnly)) {
@@ -368,6 +523,20 @@ public:
 #endif
     }
 
+    [[nodiscard]] std::unique_ptr<AbstractLockFile> readLockFile() override
+    {
+#ifdef KCONFIG_USE_FLOCK
+        // Writers replace files they own atomically (see writeToDevice()), readers only need to wait
+        // for writers truncating and rewriting the file of another user in place.
+        struct stat st;
+        if (::stat(QFile::encodeName(filePath()).constData(), &st) == 0 && st.st_uid != ::getuid()) {
+            return std::make_unique<FlockLockFile>(filePath() + QLatin1String(".lock"));
+        }
+#endif
+        // QLockFile has no shared locks, readers rely on files being replaced atomically
+        return std::make_unique<FakeLockFile>();
+    }
+
 private:
     /* the absolute path to the object */
     [[nodiscard]] QString filePath() const
@@ -375,6 +544,44 @@ private:
         return m_localFilePath;
     }
 
+#ifdef KCONFIG_USE_UNSYNCED_RENAME
+    // The new-file part of writeToDevice() like QSaveFile does it, but without waiting
+    // for the disk before renaming the new file over the old one
+    [[nodiscard]] bool writeWithoutSync(const std::function<void(QIODevice &)> &write, QFile::Permissions fileMode, bool exists, bool deferSync)
+    {
+        QTemporaryFile file(filePath() + QLatin1String(".XXXXXX"));
+        if (!file.open()) {
+            qCWarning(KCONFIG_CORE_LOG) << "Couldn't create a new file:" << filePath() << ". Error:" << file.errorString();
+            return false;
+        }
+
+        file.setTextModeEnabled(true); // to get eol translation
+        write(file);
+
+        if (!file.size() && (fileMode == (QFile::ReadUser | QFile::WriteUser))) {
+            // File is empty and doesn't have special permissions: delete it, the temporary file is removed with file
+            if (exists) {
+                QFile::remove(filePath());
+            }
+            return true;
+        }
+
+        file.close();
+        if (file.error() != QFile::NoError || !file.setPermissions(fileMode)
+            || ::rename(QFile::encodeName(file.fileName()).constData(), QFile::encodeName(filePath()).constData()) != 0) {
+            // Couldn't write. Disk full?
+            qCWarning(KCONFIG_CORE_LOG) << "Couldn't write" << filePath() << ". Disk full?";
+            return false;
+        }
+        file.setAutoRemove(false);
+
+        if (deferSync) {
+            kconfigDeferFileSync(filePath());
+        }
+        return true;
+    }
+#endif
+
     void setLocalFilePath(const QString &file)
     {
         m_localFilePath = file;
@@ -406,7 +613,7 @@ public:
         return m_device->isOpen() && m_device->isWritable();
     }
 
-    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write) override
+    [[nodiscard]] bool writeToDevice(const std::function<void(QIODevice &)> &write, [[maybe_unused]] KConfig::Durability durability) override
     {
         m_device->setTextModeEnabled(true);
         write(*m_device);
@@ -423,6 +630,11 @@ public:
         return std::make_unique<FakeLockFile>();
     }
 
+    [[nodiscard]] std::unique_ptr<AbstractLockFile> readLockFile() override
+    {
+        return std::make_unique<FakeLockFile>();
+    }
+
     void createEnclosingEntity() override
     {
         // nothing to do
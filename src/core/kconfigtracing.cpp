@@ -0,0 +1,232 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kconfigtracing_p.h"
+
+#include "kconfig_trace_log_settings.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace
+{
+QBasicAtomicInt s_enabled = Q_BASIC_ATOMIC_INITIALIZER(-1);
+thread_local QLatin1StringView s_reparseTrigger;
+
+void dumpStatistics();
+
+struct TracingData {
+    TracingData()
+    {
+        // not from the destructor, the logging categories may be gone by then
+        qAddPostRoutine(dumpStatistics);
+    }
+
+    KConfigTracing::FileStatistics &statistics(const QString &file)
+    {
+        return files[file.isEmpty() ? QStringLiteral("((anonymous))") : file];
+    }
+
+    QMutex mutex;
+    QHash<QString, KConfigTracing::FileStatistics> files;
+};
+Q_GLOBAL_STATIC(TracingData, s_tracingData)
+
+QJsonArray histogramToJson(const KConfigTracing::LockWaitHistogram &histogram)
+{
+    QJsonArray buckets;
+    for (quint64 count : histogram) {
+        buckets.append(qint64(count));
+    }
+    return buckets;
+}
+
+int lockWaitBucket(qint64 elapsedNs)
+{
+    int bucket = 0;
+    for (qint64 limitNs = 10'000; bucket < KConfigTracing::LockWaitBucketCount - 1 && elapsedNs >= limitNs; limitNs *= 10) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+QJsonObject statisticsToJson(const KConfigTracing::FileStatistics &stats)
+{
+    QJsonObject triggers;
+    for (auto it = stats.reparseTriggers.cbegin(); it != stats.reparseTriggers.cend(); ++it) {
+        triggers.insert(it.key(), qint64(it.value()));
+    }
+
+    return QJsonObject{
+        {QStringLiteral("parseCount"), qint64(stats.parseCount)},
+        {QStringLiteral("bytesRead"), qint64(stats.bytesRead)},
+        {QStringLiteral("parseTimeNs"), stats.parseTimeNs},
+        {QStringLiteral("entryCount"), qint64(stats.entryCount)},
+        {QStringLiteral("syncCount"), qint64(stats.syncCount)},
+        {QStringLiteral("lockCount"), qint64(stats.lockCount)},
+        {QStringLiteral("lockWaitNs"), stats.lockWaitNs},
+        {QStringLiteral("lockWaitHistogram"), histogramToJson(stats.lockWaitHistogram)},
+        {QStringLiteral("sharedLockCount"), qint64(stats.sharedLockCount)},
+        {QStringLiteral("sharedLockWaitNs"), stats.sharedLockWaitNs},
+        {QStringLiteral("sharedLockWaitHistogram"), histogramToJson(stats.sharedLockWaitHistogram)},
+        {QStringLiteral("writeCount"), qint64(stats.writeCount)},
+        {QStringLiteral("writeTimeNs"), stats.writeTimeNs},
+        {QStringLiteral("reparseCount"), qint64(stats.reparseCount)},
+        {QStringLiteral("reparseTriggers"), triggers},
+    };
+}
+
+QByteArray filesToJson(const QHash<QString, KConfigTracing::FileStatistics> &files)
+{
+    QJsonObject root;
+    for (auto it = files.cbegin(); it != files.cend(); ++it) {
+        root.insert(it.key(), statisticsToJson(it.value()));
+    }
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+void dumpStatistics()
+{
+    if (!KConfigTracing::isEnabled()) {
+        return;
+    }
+    const QHash<QString, KConfigTracing::FileStatistics> files = KConfigTracing::statistics();
+    if (files.isEmpty()) {
+        return;
+    }
+
+    // Log the files that cost the most, parse and write time dominate startup
+    QList<QString> names = files.keys();
+    std::sort(names.begin(), names.end(), [&files](const QString &a, const QString &b) {
+        const auto &sa = files[a];
+        const auto &sb = files[b];
+        return sa.parseTimeNs + sa.writeTimeNs + sa.lockWaitNs + sa.sharedLockWaitNs > sb.parseTimeNs + sb.writeTimeNs + sb.lockWaitNs + sb.sharedLockWaitNs;
+    });
+
+    constexpr qsizetype maxSummaryLines = 20;
+    for (qsizetype i = 0; i < std::min(maxSummaryLines, names.size()); ++i) {
+        const auto &stats = files[names.at(i)];
+        qCInfo(KCONFIG_TRACE_LOG).nospace() << names.at(i) << ": parsed " << stats.parseCount << "x (" << stats.bytesRead << " bytes, "
+                                            << stats.parseTimeNs / 1000 << " us, " << stats.entryCount << " entries, lock wait " << stats.sharedLockWaitNs / 1000
+                                            << " us), synced " << stats.syncCount
+                                            << "x (write " << stats.writeTimeNs / 1000 << " us, lock wait " << stats.lockWaitNs / 1000 << " us), reparsed "
+                                            << stats.reparseCount << "x";
+    }
+
+    const QString dumpFile = qEnvironmentVariable("KCONFIG_TRACE_FILE");
+    if (dumpFile.isEmpty()) {
+        return;
+    }
+    QFile file(dumpFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KCONFIG_TRACE_LOG) << "Could not write KConfig trace to" << dumpFile << file.errorString();
+        return;
+    }
+    file.write(filesToJson(files));
+}
+} // namespace
+
+bool KConfigTracing::isEnabled()
+{
+    int enabled = s_enabled.loadRelaxed();
+    if (enabled < 0) [[unlikely]] {
+        enabled = qEnvironmentVariableIsSet("KCONFIG_TRACE") || KCONFIG_TRACE_LOG().isDebugEnabled();
+        s_enabled.storeRelaxed(enabled);
+    }
+    return enabled;
+}
+
+void KConfigTracing::setEnabled(bool enabled)
+{
+    s_enabled.storeRelaxed(enabled);
+}
+
+void KConfigTracingInternal::recordParse(const QString &file, quint64 bytesRead, qint64 elapsedNs, quint64 entryCount)
+{
+    QMutexLocker locker(&s_tracingData->mutex);
+    auto &stats = s_tracingData->statistics(file);
+    ++stats.parseCount;
+    stats.bytesRead += bytesRead;
+    stats.parseTimeNs += elapsedNs;
+    stats.entryCount = entryCount;
+}
+
+void KConfigTracingInternal::recordSync(const QString &file)
+{
+    QMutexLocker locker(&s_tracingData->mutex);
+    ++s_tracingData->statistics(file).syncCount;
+}
+
+void KConfigTracingInternal::recordLockWait(const QString &file, qint64 elapsedNs, LockType type)
+{
+    const int bucket = lockWaitBucket(elapsedNs);
+
+    QMutexLocker locker(&s_tracingData->mutex);
+    auto &stats = s_tracingData->statistics(file);
+    if (type == SharedLock) {
+        ++stats.sharedLockCount;
+        stats.sharedLockWaitNs += elapsedNs;
+        ++stats.sharedLockWaitHistogram[bucket];
+    } else {
+        ++stats.lockCount;
+        stats.lockWaitNs += elapsedNs;
+        ++stats.lockWaitHistogram[bucket];
+    }
+}
+
+void KConfigTracingInternal::recordWrite(const QString &file, qint64 elapsedNs)
+{
+    QMutexLocker locker(&s_tracingData->mutex);
+    auto &stats = s_tracingData->statistics(file);
+    ++stats.writeCount;
+    stats.writeTimeNs += elapsedNs;
+}
+
+void KConfigTracingInternal::recordReparse(const QString &file)
+{
+    const QString trigger = s_reparseTrigger.isEmpty() ? QStringLiteral("direct") : QString(s_reparseTrigger);
+
+    QMutexLocker locker(&s_tracingData->mutex);
+    auto &stats = s_tracingData->statistics(file);
+    ++stats.reparseCount;
+    ++stats.reparseTriggers[trigger];
+}
+
+KConfigTracingInternal::ScopedReparseTrigger::ScopedReparseTrigger(QLatin1StringView trigger)
+    : m_previous(s_reparseTrigger)
+{
+    s_reparseTrigger = trigger;
+}
+
+KConfigTracingInternal::ScopedReparseTrigger::~ScopedReparseTrigger()
+{
+    s_reparseTrigger = m_previous;
+}
+
+QHash<QString, KConfigTracing::FileStatistics> KConfigTracing::statistics()
+{
+    QMutexLocker locker(&s_tracingData->mutex);
+    return s_tracingData->files;
+}
+
+void KConfigTracing::reset()
+{
+    QMutexLocker locker(&s_tracingData->mutex);
+    s_tracingData->files.clear();
+}
+
+QByteArray KConfigTracing::toJson()
+{
+    return filesToJson(statistics());
+}
@@ -0,0 +1,134 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KCONFIGTRACING_H
+#define KCONFIGTRACING_H
+
+#include <kconfigcore_export.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QString>
+
+#include <array>
+
+/*!
+ * \class KConfigTracing
+ * \inmodule KConfigCore
+ *
+ * \brief Per-file statistics about what KConfig costs the current process.
+ *
+ * Recording is off by default and then only costs a relaxed atomic load.
+ * It is turned on by setting \c KCONFIG_TRACE in the environment, by enabling
+ * debug output for the \c kf.config.core.trace logging category, or at runtime
+ * through setEnabled().
+ *
+ * When tracing was enabled, a summary of the most expensive files is logged to
+ * \c kf.config.core.trace when the QCoreApplication is destroyed and, if
+ * \c KCONFIG_TRACE_FILE names a writable path, the full statistics are written
+ * there as JSON.
+ *
+ * Files are identified by their absolute path, other configurations by a
+ * pseudo name like \c ((QIODevice)).
+ *
+ * \code
+ * KConfigTracing::setEnabled(true);
+ * loadPlugins();
+ * const auto statistics = KConfigTracing::statistics();
+ * for (auto it = statistics.cbegin(); it != statistics.cend(); ++it) {
+ *     qDebug() << it.key() << it->parseCount << it->parseTimeNs;
+ * }
+ * \endcode
+ *
+ * \since 6.30
+ */
+class KCONFIGCORE_EXPORT KConfigTracing
+{
+public:
+    /*!
+     * Number of buckets of a LockWaitHistogram.
+     */
+    static constexpr int LockWaitBucketCount = 8;
+
+    /*!
+     * Lock waits counted by duration: bucket \c i holds the waits shorter than
+     * 10^(i + 1) microseconds, i.e. < 10 us, < 100 us, ... < 10 s, and the last
+     * bucket all longer waits.
+     */
+    using LockWaitHistogram = std::array<quint64, LockWaitBucketCount>;
+
+    /*!
+     * \class KConfigTracing::FileStatistics
+     * \inmodule KConfigCore
+     *
+     * \brief The counters collected for one file.
+     *
+     * Times are in nanoseconds.
+     */
+    struct FileStatistics {
+        /*! How often the file was parsed */
+        quint64 parseCount = 0;
+        /*! Bytes read by all parses */
+        quint64 bytesRead = 0;
+        /*! Time spent parsing */
+        qint64 parseTimeNs = 0;
+        /*! Number of entries the most recent parse added to its entry map */
+        quint64 entryCount = 0;
+        /*! How often KConfig::sync() had changes to write */
+        quint64 syncCount = 0;
+        /*! How often sync() locked the file for writing */
+        quint64 lockCount = 0;
+        /*! Time sync() waited for the lock */
+        qint64 lockWaitNs = 0;
+        /*! The waits for the lock of sync() by duration */
+        LockWaitHistogram lockWaitHistogram{};
+        /*! How often a parse waited for writers of the file to finish */
+        quint64 sharedLockCount = 0;
+        /*! Time parses waited for writers */
+        qint64 sharedLockWaitNs = 0;
+        /*! The waits of parses for writers by duration */
+        LockWaitHistogram sharedLockWaitHistogram{};
+        /*! How often the file was written */
+        quint64 writeCount = 0;
+        /*! Time spent writing */
+        qint64 writeTimeNs = 0;
+        /*! How often the configuration was reparsed */
+        quint64 reparseCount = 0;
+        /*! What asked for a reparse, e.g. "open", "direct" or "KConfigWatcher", and how often */
+        QMap<QString, quint64> reparseTriggers;
+    };
+
+    KConfigTracing() = delete;
+
+    /*!
+     * Returns whether statistics are being recorded.
+     */
+    static bool isEnabled();
+
+    /*!
+     * Turns recording statistics on or off, depending on \a enabled.
+     */
+    static void setEnabled(bool enabled);
+
+    /*!
+     * Returns a snapshot of all counters collected so far, keyed by file.
+     */
+    static QHash<QString, FileStatistics> statistics();
+
+    /*!
+     * Drops all counters collected so far.
+     */
+    static void reset();
+
+    /*!
+     * Returns statistics() as an indented JSON object keyed by file.
+     */
+    static QByteArray toJson();
+};
+
+#endif // KCONFIGTRACING_H
@@ -0,0 +1,48 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KCONFIGTRACING_P_H
+#define KCONFIGTRACING_P_H
+
+#include "kconfigtracing.h"
+
+#include <QLatin1StringView>
+
+/*
+ * Recording side of KConfigTracing. Callers check KConfigTracing::isEnabled()
+ * first, so that nothing is measured while tracing is off.
+ */
+namespace KConfigTracingInternal
+{
+enum LockType {
+    ExclusiveLock, // taken by sync() to write the file
+    SharedLock, // taken while parsing, to not read a file while it is being written
+};
+
+void recordParse(const QString &file, quint64 bytesRead, qint64 elapsedNs, quint64 entryCount);
+void recordSync(const QString &file);
+void recordLockWait(const QString &file, qint64 elapsedNs, LockType type = ExclusiveLock);
+void recordWrite(const QString &file, qint64 elapsedNs);
+void recordReparse(const QString &file);
+
+/*
+ * Labels reparses happening on this thread while the object is alive,
+ * so that the statistics show what asked for them.
+ */
+class ScopedReparseTrigger
+{
+public:
+    explicit ScopedReparseTrigger(QLatin1StringView trigger);
+    ~ScopedReparseTrigger();
+    Q_DISABLE_COPY_MOVE(ScopedReparseTrigger)
+
+private:
+    QLatin1StringView m_previous;
+};
+}
+
+#endif // KCONFIGTRACING_P_H
@@ -9,6 +9,7 @@
 
 #include "config-kconfig.h"
 #include "kconfig_core_log_settings.h"
+#include "kconfigtracing_p.h"
 
 #if KCONFIG_USE_DBUS
 #include <QDBusConnection>
@@ -107,7 +108,10 @@ void KConfigWatcher::onConfigChangeNotification(const QHash<QString, QByteArrayL
 {
     // should we ever need it we can determine the file changed with  QDbusContext::message().path(), but it doesn't seem too useful
 
-    d->m_config->reparseConfiguration();
+    {
+        KConfigTracingInternal::ScopedReparseTrigger trigger(QLatin1StringView("KConfigWatcher"));
+        d->m_config->reparseConfiguration();
+    }
 
     QPointer guard(this);
     for (auto it = changes.constBegin(); it != changes.constEnd(); it++) {
@@ -14,17 +14,28 @@
 #include "kconfiggroup.h"
 #include "kconfigini_p.h"
 #include "kdesktopfileaction.h"
+#include "kdesktopfilerecord.h"
+#include "kdesktopfilerecord_p.h"
 
+#include <QCache>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QStandardPaths>
+#include <QThreadPool>
 #include <QUrl>
+#include <QWaitCondition>
+#include <qplatformdefs.h>
 
 #ifndef Q_OS_WIN
 #include <unistd.h>
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 
 class KDesktopFilePrivate : public KConfigPrivate
 {
@@ -95,6 +106,209 @@ bool KDesktopFile::isDesktopFile(const QString &path)
     return path.endsWith(QLatin1String(".desktop"));
 }
 
+namespace
+{
+#ifndef Q_OS_WIN
+constexpr Qt::CaseSensitivity sPathSensitivity = Qt::CaseSensitive;
+#else
+constexpr Qt::CaseSensitivity sPathSensitivity = Qt::CaseInsensitive;
+#endif
+
+// A directory whose .desktop files are trusted, e.g. /usr/share/applications
+struct TrustedDirectory {
+    QString path;
+    // empty as long as the directory doesn't exist
+    QString canonicalPath;
+};
+
+// What isAuthorizedDesktopFile() decided for a file, and the state of the file it decided on
+struct DesktopFileVerdict {
+    quint64 device;
+    quint64 inode;
+    qint64 modificationTime;
+    qint64 statusChangeTime;
+    bool runDesktopFilesAuthorized;
+    bool authorized;
+};
+
+/*
+ * Keeps the canonical paths of the trusted directories instead of resolving
+ * them for every file, and remembers the recent verdicts. A verdict is reused
+ * as long as the file keeps its inode and its modification and status change
+ * times, i.e. it wasn't replaced, edited or chmod'ed, and the run_desktop_files
+ * restriction didn't change. All verdicts are dropped when the trusted
+ * directories change.
+ */
+class AuthorizedDesktopFileCache
+{
+public:
+    // Updates the trusted directories if needed, must be called with mutex held
+    void update()
+    {
+        const QStringList appsLocations = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+        const QStringList configLocations = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation);
+        if (appsLocations != m_appsLocations || configLocations != m_configLocations) {
+            m_appsLocations = appsLocations;
+            m_configLocations = configLocations;
+            m_appsDirs = trustedDirectories(appsLocations, QString());
+            m_autostartDirs = trustedDirectories(configLocations, QStringLiteral("/autostart/"));
+            verdicts.clear();
+            return;
+        }
+
+        // A directory that didn't exist before might have been created since
+        if (resolveMissing(m_appsDirs, QString()) | resolveMissing(m_autostartDirs, QStringLiteral("/autostart/"))) {
+            verdicts.clear();
+        }
+    }
+
+    // Whether realPath (or path) is below one of the trusted directories, must be called with mutex held
+    bool isTrusted(const QString &realPath, const QString &path) const
+    {
+        const bool inAppsDir = std::any_of(m_appsDirs.cbegin(), m_appsDirs.cend(), [&realPath, &path](const TrustedDirectory &dir) {
+            return !dir.canonicalPath.isEmpty() && (realPath.startsWith(dir.canonicalPath, sPathSensitivity) || path.startsWith(dir.canonicalPath));
+        });
+        return inAppsDir || std::any_of(m_autostartDirs.cbegin(), m_autostartDirs.cend(), [&realPath](const TrustedDirectory &dir) {
+                   return !dir.canonicalPath.isEmpty() && realPath.startsWith(dir.canonicalPath, sPathSensitivity);
+               });
+    }
+
+    QMutex mutex;
+    QCache<QString, DesktopFileVerdict> verdicts{512};
+
+private:
+    static QString canonicalDirPath(const QString &path, const QString &suffix)
+    {
+        const QFileInfo info(path);
+        if (info.exists() && info.isDir()) {
+            return info.canonicalFilePath() + suffix;
+        }
+        return QString();
+    }
+
+    // the suffix is appended to the canonical path, e.g. the autostart subdirectory
+    static QList<TrustedDirectory> trustedDirectories(const QStringList &locations, const QString &suffix)
+    {
+        QList<TrustedDirectory> dirs;
+        dirs.reserve(locations.size());
+        for (const QString &location : locations) {
+            dirs.append({location, canonicalDirPath(location, suffix)});
+        }
+        return dirs;
+    }
+
+    static bool resolveMissing(QList<TrustedDirectory> &dirs, const QString &suffix)
+    {
+        bool resolved = false;
+        for (TrustedDirectory &dir : dirs) {
+            if (dir.canonicalPath.isEmpty()) {
+                dir.canonicalPath = canonicalDirPath(dir.path, suffix);
+                resolved |= !dir.canonicalPath.isEmpty();
+            }
+        }
+        return resolved;
+    }
+
+    QStringList m_appsLocations;
+    QStringList m_configLocations;
+    QList<TrustedDirectory> m_appsDirs;
+    QList<TrustedDirectory> m_autostartDirs;
+};
+Q_GLOBAL_STATIC(AuthorizedDesktopFileCache, s_authorizedDesktopFileCache)
+
+/*
+ * Calls function for every index in [0, count), spread over the global thread pool
+ * and the calling thread. Returns once all calls returned.
+ */
+template<typename Function>
+void runConcurrently(qsizetype count, const Function &function)
+{
+    // below this, handing work to other threads costs more than it saves
+    constexpr qsizetype minimumCountPerThread = 8;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const qsizetype threadCount = std::min<qsizetype>(pool->maxThreadCount(), count / minimumCountPerThread);
+    if (threadCount < 2) {
+        for (qsizetype i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    struct State {
+        std::atomic<qsizetype> next = 0;
+        std::atomic<qsizetype> done = 0;
+        QMutex mutex;
+        QWaitCondition finished;
+    };
+    // Helpers that only start once all work is taken must not touch anything on this stack
+    auto state = std::make_shared<State>();
+    auto work = [state, count, &function] {
+        for (qsizetype i = state->next++; i < count; i = state->next++) {
+            function(i);
+            if (++state->done == count) {
+                QMutexLocker locker(&state->mutex);
+                state->finished.wakeAll();
+            }
+        }
+    };
+
+    for (qsizetype i = 1; i < threadCount; ++i) {
+        pool->start(work);
+    }
+    work();
+
+    QMutexLocker locker(&state->mutex);
+    while (state->done < count) {
+        state->finished.wait(&state->mutex);
+    }
+}
+} // namespace
+
+QList<KDesktopFileRecord> KDesktopFile::readRecords(const QStringList &paths, const QStringList &keys)
+{
+    const QByteArray locale = KConfigPrivate::defaultLocaleName().toUtf8();
+    QList<QByteArray> utf8Keys;
+    utf8Keys.reserve(keys.size());
+    for (const QString &key : keys) {
+        utf8Keys.append(key.toUtf8());
+    }
+
+    QList<KDesktopFileRecord> records(paths.size());
+    KDesktopFileRecord *output = records.data();
+    runConcurrently(paths.size(), [&](qsizetype i) {
+        auto *record = new KDesktopFileRecordPrivate;
+        record->path = paths.at(i);
+        record->keys = keys;
+
+        if (QDir::isAbsolutePath(record->path)) {
+            KConfigIniBackend backend(std::make_unique<KConfigIniBackendPathDevice>(record->path));
+            bool groupFound = false;
+            const QList<KConfigIniBackend::GroupEntry> entries = backend.parseGroupEntries(locale, "Desktop Entry", utf8Keys, &groupFound);
+            record->valid = groupFound;
+            record->values.reserve(entries.size());
+            for (const KConfigIniBackend::GroupEntry &entry : entries) {
+                if (!entry.found) {
+                    record->values.append(QString());
+                    continue;
+                }
+                QString value = QString::fromUtf8(entry.value);
+                if (value.isNull()) {
+                    value = QStringLiteral(""); // keep it apart from keys that are missing
+                }
+                record->values.append(entry.expand ? KConfigPrivate::expandString(value) : value);
+            }
+        } else {
+            qCWarning(KCONFIG_CORE_LOG) << "KDesktopFile::readRecords() needs absolute paths, got" << record->path;
+            record->values.resize(keys.size());
+        }
+
+        output[i] = KDesktopFileRecord(record);
+    });
+
+    return records;
+}
+
 bool KDesktopFile::isAuthorizedDesktopFile(const QString &path)
 {
     if (path.isEmpty()) {
@@ -105,56 +319,71 @@ bool KDesktopFile::isAuthorizedDesktopFile(const QString &path)
         return true; // Relative paths are ok.
     }
 
+    QT_STATBUF buf;
+    if (QT_STAT(QFile::encodeName(path).constData(), &buf) != 0) {
+        return false; // File doesn't exist.
+    }
+
+    const bool runDesktopFilesAuthorized = KAuthorized::authorize(KAuthorized::RUN_DESKTOP_FILES);
+    AuthorizedDesktopFileCache *cache = s_authorizedDesktopFileCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        cache->update();
+        const DesktopFileVerdict *verdict = cache->verdicts.object(path);
+        if (verdict && verdict->device == quint64(buf.st_dev) && verdict->inode == quint64(buf.st_ino) && verdict->modificationTime == qint64(buf.st_mtime)
+            && verdict->statusChangeTime == qint64(buf.st_ctime) && verdict->runDesktopFilesAuthorized == runDesktopFilesAuthorized) {
+            return verdict->authorized;
+        }
+    }
+
+    auto remember = [&](bool authorized) {
+        // The times only have a resolution of seconds, a file changed in this very second
+        // could change again without it showing, so such a verdict isn't kept
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        if (qint64(buf.st_mtime) >= now || qint64(buf.st_ctime) >= now) {
+            return authorized;
+        }
+        QMutexLocker locker(&cache->mutex);
+        cache->verdicts.insert(path,
+                               new DesktopFileVerdict{quint64(buf.st_dev),
+                                                      quint64(buf.st_ino),
+                                                      qint64(buf.st_mtime),
+                                                      qint64(buf.st_ctime),
+                                                      runDesktopFilesAuthorized,
+                                                      authorized});
+        return authorized;
+    };
+
     const QString realPath = QFileInfo(path).canonicalFilePath();
     if (realPath.isEmpty()) {
         return false; // File doesn't exist.
     }
 
-#ifndef Q_OS_WIN
-    static constexpr Qt::CaseSensitivity sensitivity = Qt::CaseSensitive;
-#else
-    static constexpr Qt::CaseSensitivity sensitivity = Qt::CaseInsensitive;
-#endif
-
     // Check if the .desktop file is installed as part of KDE or XDG.
-    const QStringList appsDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-    auto it = std::find_if(appsDirs.cbegin(), appsDirs.cend(), [&realPath, &path](const QString &prefix) {
-        QFileInfo info(prefix);
-        return info.exists() && info.isDir() && (realPath.startsWith(info.canonicalFilePath(), sensitivity) || path.startsWith(info.canonicalFilePath()));
-    });
-    if (it != appsDirs.cend()) {
-        return true;
+    bool trusted;
+    {
+        QMutexLocker locker(&cache->mutex);
+        trusted = cache->isTrusted(realPath, path);
     }
-
-    const QString autostartDir = QStringLiteral("autostart/");
-    const QStringList lstConfigPath = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation);
-    auto configIt = std::find_if(lstConfigPath.cbegin(), lstConfigPath.cend(), [&realPath, &autostartDir](const QString &xdgDataPrefix) {
-        QFileInfo info(xdgDataPrefix);
-        if (info.exists() && info.isDir()) {
-            const QString prefix = info.canonicalFilePath();
-            return realPath.startsWith(prefix + QLatin1Char('/') + autostartDir, sensitivity);
-        }
-        return false;
-    });
-    if (configIt != lstConfigPath.cend()) {
-        return true;
+    if (trusted) {
+        return remember(true);
     }
 
     // Forbid desktop files outside of standard locations if kiosk is set so
-    if (!KAuthorized::authorize(QStringLiteral("run_desktop_files"))) {
+    if (!runDesktopFilesAuthorized) {
         qCWarning(KCONFIG_CORE_LOG) << "Access to" << path << "denied because of 'run_desktop_files' restriction.";
-        return false;
+        return remember(false);
     }
 
     // Not otherwise permitted, so only allow if the file is executable, or if
     // owned by root (uid == 0)
     QFileInfo entryInfo(path);
     if (entryInfo.isExecutable() || entryInfo.ownerId() == 0) {
-        return true;
+        return remember(true);
     }
 
     qCInfo(KCONFIG_CORE_LOG) << "Access to" << path << "denied, not owned by root and executable flag not set.";
-    return false;
+    return remember(false);
 }
 
 QString KDesktopFile::readType() const
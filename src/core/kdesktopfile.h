@@ -12,6 +12,7 @@
 class KConfigGroup;
 class KDesktopFileAction;
 class KDesktopFilePrivate;
+class KDesktopFileRecord;
 
 /*!
  * \class KDesktopFile
@@ -75,6 +76,32 @@ public:
      */
     static bool isAuthorizedDesktopFile(const QString &path);
 
+    /*!
+     * Reads the \a keys of the [Desktop Entry] group of all the desktop files in \a paths.
+     *
+     * This is meant for reading a few keys of many files, e.g. when building
+     * a menu. The files are read in parallel, translations for locales other
+     * than the current one are skipped and reading a file stops at the end of
+     * its [Desktop Entry] group. Unlike KDesktopFile, no cascade of files is
+     * read, every path is read on its own.
+     *
+     * \a paths must be absolute. Returns one record per path, in the same order.
+     * Records of files that can't be read or that have no [Desktop Entry] group
+     * are invalid.
+     *
+     * \code
+     * const auto records = KDesktopFile::readRecords(paths, {QStringLiteral("Name"), QStringLiteral("Icon"), QStringLiteral("NoDisplay")});
+     * for (const KDesktopFileRecord &record : records) {
+     *     if (record.isValid() && record.value(QStringLiteral("NoDisplay")) != QLatin1String("true")) {
+     *         addItem(record.value(QStringLiteral("Name")), record.value(QStringLiteral("Icon")));
+     *     }
+     * }
+     * \endcode
+     *
+     * \since 6.30
+     */
+    static QList<KDesktopFileRecord> readRecords(const QStringList &paths, const QStringList &keys);
+
     /*!
      * Returns the appropriate location to use to write changes to the desktop file based on the given \a path.
      *
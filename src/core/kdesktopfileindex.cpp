@@ -0,0 +1,448 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kdesktopfileindex.h"
+
+#include "kconfig_core_log_settings.h"
+#include "kconfig_p.h"
+#include "kconfiggroup_p.h"
+#include "kdesktopfile.h"
+#include "kdesktopfilerecord.h"
+#include "kdesktopfilerecord_p.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimeZone>
+
+#include <algorithm>
+
+namespace
+{
+constexpr quint32 s_cacheMagic = 0x4b444649; // "KDFI"
+constexpr quint32 s_cacheVersion = 1;
+
+// Modification times this close to now may still change without the time changing,
+// on file systems with a coarse resolution. Such times aren't remembered, so the
+// file or directory is looked at again on the next update.
+constexpr qint64 s_unsettledTimeMs = 2000;
+
+struct IndexedFile {
+    QString fileName;
+    qint64 modificationTime = -1;
+    KDesktopFileRecord record;
+};
+
+struct IndexedDirectory {
+    qint64 modificationTime = -1;
+    QStringList subdirectories;
+    QList<IndexedFile> files;
+};
+
+qint64 modificationTime(const QFileInfo &info)
+{
+    return info.lastModified(QTimeZone::UTC).toMSecsSinceEpoch();
+}
+} // namespace
+
+class KDesktopFileIndexPrivate
+{
+public:
+    explicit KDesktopFileIndexPrivate(const QStringList &dirs);
+
+    void ensureUpToDate()
+    {
+        if (!upToDate) {
+            update();
+        }
+    }
+    void update();
+    bool updateDirectory(const QString &path, QSet<QString> &visited, QSet<QString> &canonicalPaths);
+    void rebuildRecords();
+    void collectRecords(const QString &root, const QString &path);
+    const KDesktopFileRecord *find(const QString &desktopFileId);
+
+    void load();
+    void save() const;
+    static KDesktopFileRecord makeRecord(const QString &path, bool valid, const QStringList &values);
+
+    QStringList directories;
+    QString locale;
+    QString cacheFile;
+    QHash<QString, IndexedDirectory> indexedDirectories;
+    QHash<QString, KDesktopFileRecord> records;
+    bool loaded = false;
+    bool upToDate = false;
+};
+
+static const QStringList &indexedKeyList()
+{
+    static const QStringList keys{
+        QStringLiteral("Type"),
+        QStringLiteral("Name"),
+        QStringLiteral("Icon"),
+        QStringLiteral("NoDisplay"),
+        QStringLiteral("MimeType"),
+        QStringLiteral("Actions"),
+    };
+    return keys;
+}
+
+KDesktopFileIndexPrivate::KDesktopFileIndexPrivate(const QStringList &dirs)
+    : locale(KConfigPrivate::defaultLocaleName())
+{
+    directories.reserve(dirs.size());
+    for (const QString &dir : dirs) {
+        const QString cleaned = QDir::cleanPath(dir);
+        if (!cleaned.isEmpty() && !directories.contains(cleaned)) {
+            directories.append(cleaned);
+        }
+    }
+
+    // one cache file per set of directories and locale, so processes using
+    // different ones don't keep overwriting each other's index
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(directories.join(QLatin1Char(':')).toUtf8());
+    hash.addData(QByteArrayView("\n"));
+    hash.addData(locale.toUtf8());
+    cacheFile = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kconfig/desktopfileindex-")
+        + QString::fromLatin1(hash.result().toHex().left(16)) + QLatin1String(".cache");
+}
+
+KDesktopFileRecord KDesktopFileIndexPrivate::makeRecord(const QString &path, bool valid, const QStringList &values)
+{
+    auto *record = new KDesktopFileRecordPrivate;
+    record->path = path;
+    record->keys = indexedKeyList();
+    record->values = values;
+    record->values.resize(record->keys.size());
+    record->valid = valid;
+    return KDesktopFileRecord(record);
+}
+
+void KDesktopFileIndexPrivate::update()
+{
+    if (!loaded) {
+        load();
+        loaded = true;
+    }
+
+    QSet<QString> visited;
+    QSet<QString> canonicalPaths;
+    bool changed = false;
+    for (const QString &dir : std::as_const(directories)) {
+        changed |= updateDirectory(dir, visited, canonicalPaths);
+    }
+
+    // forget about directories that are gone
+    for (auto it = indexedDirectories.begin(); it != indexedDirectories.end();) {
+        if (visited.contains(it.key())) {
+            ++it;
+        } else {
+            it = indexedDirectories.erase(it);
+            changed = true;
+        }
+    }
+
+    if (changed || !upToDate) {
+        rebuildRecords();
+    }
+    if (changed) {
+        save();
+    }
+    upToDate = true;
+}
+
+bool KDesktopFileIndexPrivate::updateDirectory(const QString &path, QSet<QString> &visited, QSet<QString> &canonicalPaths)
+{
+    if (visited.contains(path)) {
+        return false;
+    }
+    const QFileInfo info(path);
+    if (!info.isDir()) {
+        return false;
+    }
+    // Symlinks can lead to a directory seen before, or to one of its parents. Its files keep
+    // the ids they got there, and a loop of links isn't followed forever.
+    const QString canonicalPath = info.canonicalFilePath();
+    if (canonicalPaths.contains(canonicalPath)) {
+        return false;
+    }
+    canonicalPaths.insert(canonicalPath);
+    visited.insert(path);
+
+    const qint64 unsettled = QDateTime::currentMSecsSinceEpoch() - s_unsettledTimeMs;
+    const qint64 dirTime = modificationTime(info);
+
+    bool changed = false;
+    QStringList subdirectories;
+    {
+        IndexedDirectory &directory = indexedDirectories[path];
+        if (directory.modificationTime != dirTime) {
+            QHash<QString, qsizetype> previous;
+            previous.reserve(directory.files.size());
+            for (qsizetype i = 0; i < directory.files.size(); ++i) {
+                previous.insert(directory.files.at(i).fileName, i);
+            }
+
+            QList<IndexedFile> files;
+            QStringList toRead;
+            QList<qsizetype> toReadIndexes;
+            QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+            while (it.hasNext()) {
+                const QFileInfo entry = it.nextFileInfo();
+                if (entry.isDir()) {
+                    subdirectories.append(entry.fileName());
+                    continue;
+                }
+                if (!entry.fileName().endsWith(QLatin1String(".desktop"))) {
+                    continue;
+                }
+
+                const qint64 fileTime = modificationTime(entry);
+                const auto old = previous.constFind(entry.fileName());
+                if (old != previous.cend() && directory.files.at(*old).modificationTime == fileTime) {
+                    files.append(directory.files.at(*old));
+                    continue;
+                }
+                toReadIndexes.append(files.size());
+                toRead.append(entry.filePath());
+                files.append(IndexedFile{entry.fileName(), fileTime >= unsettled ? -1 : fileTime, KDesktopFileRecord()});
+            }
+
+            const QList<KDesktopFileRecord> read = KDesktopFile::readRecords(toRead, indexedKeyList());
+            for (qsizetype i = 0; i < read.size(); ++i) {
+                files[toReadIndexes.at(i)].record = read.at(i);
+            }
+
+            std::sort(files.begin(), files.end(), [](const IndexedFile &a, const IndexedFile &b) {
+                return a.fileName < b.fileName;
+            });
+            subdirectories.sort();
+
+            directory.files = std::move(files);
+            directory.subdirectories = subdirectories;
+            directory.modificationTime = dirTime >= unsettled ? -1 : dirTime;
+            changed = true;
+        } else {
+            subdirectories = directory.subdirectories;
+        }
+    }
+
+    // the reference into indexedDirectories isn't used anymore, the recursion may insert into it
+    for (const QString &subdirectory : std::as_const(subdirectories)) {
+        changed |= updateDirectory(path + QLatin1Char('/') + subdirectory, visited, canonicalPaths);
+    }
+    return changed;
+}
+
+void KDesktopFileIndexPrivate::rebuildRecords()
+{
+    records.clear();
+    for (const QString &dir : std::as_const(directories)) {
+        collectRecords(dir, dir);
+    }
+}
+
+void KDesktopFileIndexPrivate::collectRecords(const QString &root, const QString &path)
+{
+    const auto it = indexedDirectories.constFind(path);
+    if (it == indexedDirectories.cend()) {
+        return;
+    }
+
+    // the desktop file id of "root/kde/foo.desktop" is "kde-foo.desktop"
+    QString prefix;
+    if (path.size() > root.size()) {
+        prefix = path.mid(root.size() + 1).replace(QLatin1Char('/'), QLatin1Char('-')) + QLatin1Char('-');
+    }
+    // the first file found by id wins, even if it can't be read
+    for (const IndexedFile &file : it->files) {
+        records.tryEmplace(prefix + file.fileName, file.record);
+    }
+    for (const QString &subdirectory : it->subdirectories) {
+        collectRecords(root, path + QLatin1Char('/') + subdirectory);
+    }
+}
+
+const KDesktopFileRecord *KDesktopFileIndexPrivate::find(const QString &desktopFileId)
+{
+    ensureUpToDate();
+    const auto it = records.constFind(desktopFileId);
+    return it == records.cend() || !it->isValid() ? nullptr : &it.value();
+}
+
+void KDesktopFileIndexPrivate::load()
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_9);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString cachedLocale;
+    QStringList cachedDirectories;
+    QStringList cachedKeys;
+    stream >> magic >> version >> cachedLocale >> cachedDirectories >> cachedKeys;
+    if (magic != s_cacheMagic || version != s_cacheVersion || cachedLocale != locale || cachedDirectories != directories
+        || cachedKeys != indexedKeyList()) {
+        return;
+    }
+
+    QHash<QString, IndexedDirectory> dirs;
+    qint64 dirCount = 0;
+    stream >> dirCount;
+    for (qint64 i = 0; i < dirCount && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        IndexedDirectory directory;
+        qint64 fileCount = 0;
+        stream >> path >> directory.modificationTime >> directory.subdirectories >> fileCount;
+        for (qint64 j = 0; j < fileCount && stream.status() == QDataStream::Ok; ++j) {
+            IndexedFile indexedFile;
+            bool valid = false;
+            QStringList values;
+            stream >> indexedFile.fileName >> indexedFile.modificationTime >> valid >> values;
+            indexedFile.record = makeRecord(path + QLatin1Char('/') + indexedFile.fileName, valid, values);
+            directory.files.append(std::move(indexedFile));
+        }
+        dirs.insert(path, std::move(directory));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KCONFIG_CORE_LOG) << "Ignoring corrupt desktop file index" << cacheFile;
+        return;
+    }
+    indexedDirectories = std::move(dirs);
+}
+
+void KDesktopFileIndexPrivate::save() const
+{
+    if (!QDir().mkpath(QFileInfo(cacheFile).absolutePath())) {
+        return;
+    }
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KCONFIG_CORE_LOG) << "Could not write desktop file index" << cacheFile << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_9);
+    stream << s_cacheMagic << s_cacheVersion << locale << directories << indexedKeyList();
+    stream << qint64(indexedDirectories.size());
+    for (auto it = indexedDirectories.cbegin(); it != indexedDirectories.cend(); ++it) {
+        stream << it.key() << it->modificationTime << it->subdirectories << qint64(it->files.size());
+        for (const IndexedFile &indexedFile : it->files) {
+            stream << indexedFile.fileName << indexedFile.modificationTime << indexedFile.record.isValid() << indexedFile.record.d->values;
+        }
+    }
+
+    if (!file.commit()) {
+        qCWarning(KCONFIG_CORE_LOG) << "Could not write desktop file index" << cacheFile << file.errorString();
+    }
+}
+
+KDesktopFileIndex::KDesktopFileIndex(QStandardPaths::StandardLocation location)
+    : KDesktopFileIndex(QStandardPaths::standardLocations(location))
+{
+}
+
+KDesktopFileIndex::KDesktopFileIndex(const QStringList &directories)
+    : d(new KDesktopFileIndexPrivate(directories))
+{
+}
+
+KDesktopFileIndex::~KDesktopFileIndex() = default;
+
+QStringList KDesktopFileIndex::indexedKeys()
+{
+    return indexedKeyList();
+}
+
+void KDesktopFileIndex::update()
+{
+    d->update();
+}
+
+QStringList KDesktopFileIndex::desktopFileIds() const
+{
+    d->ensureUpToDate();
+    QStringList ids;
+    ids.reserve(d->records.size());
+    for (auto it = d->records.cbegin(); it != d->records.cend(); ++it) {
+        if (it->isValid()) {
+            ids.append(it.key());
+        }
+    }
+    ids.sort();
+    return ids;
+}
+
+bool KDesktopFileIndex::contains(const QString &desktopFileId) const
+{
+    return d->find(desktopFileId) != nullptr;
+}
+
+QString KDesktopFileIndex::locate(const QString &desktopFileId) const
+{
+    const KDesktopFileRecord *record = d->find(desktopFileId);
+    return record ? record->path() : QString();
+}
+
+KDesktopFileRecord KDesktopFileIndex::record(const QString &desktopFileId) const
+{
+    const KDesktopFileRecord *record = d->find(desktopFileId);
+    return record ? *record : KDesktopFileRecord();
+}
+
+QString KDesktopFileIndex::readType(const QString &desktopFileId) const
+{
+    return record(desktopFileId).value(QStringLiteral("Type"));
+}
+
+QString KDesktopFileIndex::readName(const QString &desktopFileId) const
+{
+    return record(desktopFileId).value(QStringLiteral("Name"));
+}
+
+QString KDesktopFileIndex::readIcon(const QString &desktopFileId) const
+{
+    return record(desktopFileId).value(QStringLiteral("Icon"));
+}
+
+bool KDesktopFileIndex::noDisplay(const QString &desktopFileId) const
+{
+    // same conversion as KConfigGroup::readEntry(key, false)
+    const QString value = record(desktopFileId).value(QStringLiteral("NoDisplay"));
+    if (value.isNull()) {
+        return false;
+    }
+    static const QLatin1StringView negatives[] = {QLatin1StringView("false"), QLatin1StringView("no"), QLatin1StringView("off"), QLatin1StringView("0")};
+    return std::none_of(std::begin(negatives), std::end(negatives), [&value](QLatin1StringView negative) {
+        return value.compare(negative, Qt::CaseInsensitive) == 0;
+    });
+}
+
+QStringList KDesktopFileIndex::readMimeTypes(const QString &desktopFileId) const
+{
+    return KConfigListCodec::deserializeXdgList(record(desktopFileId).value(QStringLiteral("MimeType")));
+}
+
+QStringList KDesktopFileIndex::readActions(const QString &desktopFileId) const
+{
+    return KConfigListCodec::deserializeXdgList(record(desktopFileId).value(QStringLiteral("Actions")));
+}
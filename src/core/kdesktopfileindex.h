@@ -0,0 +1,155 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDESKTOPFILEINDEX_H
+#define KDESKTOPFILEINDEX_H
+
+#include <kconfigcore_export.h>
+
+#include <QStandardPaths>
+#include <QStringList>
+
+#include <memory>
+
+class KDesktopFileIndexPrivate;
+class KDesktopFileRecord;
+
+/*!
+ * \class KDesktopFileIndex
+ * \inmodule KConfigCore
+ *
+ * \brief Index of the commonly read entries of all installed desktop files.
+ *
+ * Finding "the desktop file for X" usually means locating it in the
+ * standard paths, opening a KDesktopFile and reading a handful of keys.
+ * KDesktopFileIndex does this once for all the desktop files found below
+ * a standard location and keeps the result in a cache file, so that
+ * the entries read by KDesktopFile::readType(), KDesktopFile::readName(),
+ * KDesktopFile::readIcon(), KDesktopFile::noDisplay(), KDesktopFile::readMimeTypes()
+ * and KDesktopFile::readActions() can be looked up without opening any file.
+ *
+ * Desktop files are identified by their desktop file id as defined by the
+ * Desktop Entry Specification, e.g. \c org.kde.foo.desktop, or
+ * \c kde-foo.desktop for \c kde/foo.desktop. If several directories
+ * contain a file with the same id, the one in the directory with the
+ * highest priority wins, just like with QStandardPaths::locate(). This is
+ * also the case if that file can't be read or has no [Desktop Entry] group,
+ * the id is then unknown to the index.
+ *
+ * The index is brought up to date when it's first used and whenever
+ * update() is called. Only directories whose modification time changed are
+ * listed again, and only new or modified files in them are read again.
+ * Changes that don't touch the directory, like rewriting a file in
+ * place, are picked up when the directory changes the next time.
+ *
+ * \code
+ * KDesktopFileIndex index;
+ * if (!index.noDisplay(QStringLiteral("org.kde.dolphin.desktop"))) {
+ *     addItem(index.readName(QStringLiteral("org.kde.dolphin.desktop")), index.readIcon(QStringLiteral("org.kde.dolphin.desktop")));
+ * }
+ * \endcode
+ *
+ * Like KConfig, a KDesktopFileIndex object must not be used from several
+ * threads at the same time.
+ *
+ * \since 6.30
+ * \sa KDesktopFile
+ */
+class KCONFIGCORE_EXPORT KDesktopFileIndex
+{
+public:
+    /*!
+     * Constructs an index of the desktop files in all the directories of \a location.
+     */
+    explicit KDesktopFileIndex(QStandardPaths::StandardLocation location = QStandardPaths::ApplicationsLocation);
+
+    /*!
+     * Constructs an index of the desktop files in \a directories,
+     * the first directory having the highest priority.
+     */
+    explicit KDesktopFileIndex(const QStringList &directories);
+
+    ~KDesktopFileIndex();
+
+    KDesktopFileIndex(const KDesktopFileIndex &) = delete;
+    KDesktopFileIndex &operator=(const KDesktopFileIndex &) = delete;
+
+    /*!
+     * Returns the keys of the [Desktop Entry] group that are kept in the index.
+     */
+    static QStringList indexedKeys();
+
+    /*!
+     * Brings the index up to date with the directories it covers,
+     * and writes it back to its cache file if anything changed.
+     */
+    void update();
+
+    /*!
+     * Returns the ids of all indexed desktop files.
+     */
+    QStringList desktopFileIds() const;
+
+    /*!
+     * Returns whether there is a desktop file with the id \a desktopFileId.
+     */
+    bool contains(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the path of the desktop file with the id \a desktopFileId,
+     * or an empty string if there is no such file.
+     */
+    QString locate(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the indexed entries of the desktop file with the id \a desktopFileId.
+     *
+     * The record is invalid if there is no such file.
+     */
+    KDesktopFileRecord record(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the value of the "Type=" entry of \a desktopFileId.
+     * \sa KDesktopFile::readType()
+     */
+    QString readType(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the value of the "Name=" entry of \a desktopFileId.
+     * \sa KDesktopFile::readName()
+     */
+    QString readName(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the value of the "Icon=" entry of \a desktopFileId.
+     * \sa KDesktopFile::readIcon()
+     */
+    QString readIcon(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the value of the "NoDisplay=" entry of \a desktopFileId.
+     * \sa KDesktopFile::noDisplay()
+     */
+    bool noDisplay(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the list of MIME types of \a desktopFileId.
+     * \sa KDesktopFile::readMimeTypes()
+     */
+    QStringList readMimeTypes(const QString &desktopFileId) const;
+
+    /*!
+     * Returns the list of actions of \a desktopFileId.
+     * \sa KDesktopFile::readActions()
+     */
+    QStringList readActions(const QString &desktopFileId) const;
+
+private:
+    std::unique_ptr<KDesktopFileIndexPrivate> const d;
+};
+
+#endif
@@ -0,0 +1,55 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "kdesktopfilerecord.h"
+#include "kdesktopfilerecord_p.h"
+
+KDesktopFileRecord::KDesktopFileRecord()
+    : d(new KDesktopFileRecordPrivate)
+{
+}
+
+KDesktopFileRecord::KDesktopFileRecord(KDesktopFileRecordPrivate *dd)
+    : d(dd)
+{
+}
+
+KDesktopFileRecord::KDesktopFileRecord(const KDesktopFileRecord &other) = default;
+KDesktopFileRecord &KDesktopFileRecord::operator=(const KDesktopFileRecord &other) = default;
+KDesktopFileRecord::KDesktopFileRecord(KDesktopFileRecord &&other) = default;
+KDesktopFileRecord &KDesktopFileRecord::operator=(KDesktopFileRecord &&other) = default;
+KDesktopFileRecord::~KDesktopFileRecord() = default;
+
+bool KDesktopFileRecord::isValid() const
+{
+    return d->valid;
+}
+
+QString KDesktopFileRecord::path() const
+{
+    return d->path;
+}
+
+QStringList KDesktopFileRecord::keys() const
+{
+    return d->keys;
+}
+
+bool KDesktopFileRecord::hasKey(const QString &key) const
+{
+    const qsizetype index = d->keys.indexOf(key);
+    return index >= 0 && !d->values.at(index).isNull();
+}
+
+QString KDesktopFileRecord::value(const QString &key, const QString &defaultValue) const
+{
+    const qsizetype index = d->keys.indexOf(key);
+    if (index < 0 || d->values.at(index).isNull()) {
+        return defaultValue;
+    }
+    return d->values.at(index);
+}
@@ -0,0 +1,84 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDESKTOPFILERECORD_H
+#define KDESKTOPFILERECORD_H
+
+#include <kconfigcore_export.h>
+
+#include <QSharedDataPointer>
+#include <QString>
+#include <QStringList>
+
+class KDesktopFileRecordPrivate;
+
+/*!
+ * \class KDesktopFileRecord
+ * \inmodule KConfigCore
+ *
+ * \brief Read-only selection of the entries of a desktop file.
+ *
+ * Records are created by KDesktopFile::readRecords(), which reads many desktop
+ * files at once. A record only holds the keys that were asked for, translated
+ * to the current locale where a translation exists.
+ *
+ * \since 6.30
+ * \sa KDesktopFile
+ */
+class KCONFIGCORE_EXPORT KDesktopFileRecord
+{
+public:
+    /*!
+     * Constructs an invalid KDesktopFileRecord.
+     */
+    KDesktopFileRecord();
+
+    KDesktopFileRecord(const KDesktopFileRecord &other);
+    KDesktopFileRecord &operator=(const KDesktopFileRecord &other);
+    KDesktopFileRecord(KDesktopFileRecord &&other);
+    KDesktopFileRecord &operator=(KDesktopFileRecord &&other);
+    ~KDesktopFileRecord();
+
+    /*!
+     * Returns whether the file could be read and has a [Desktop Entry] group.
+     */
+    bool isValid() const;
+
+    /*!
+     * Returns the path of the desktop file this record was read from.
+     */
+    QString path() const;
+
+    /*!
+     * Returns the keys this record was read with.
+     */
+    QStringList keys() const;
+
+    /*!
+     * Returns whether the [Desktop Entry] group of the file has \a key.
+     *
+     * This is always \c false for keys that weren't asked for.
+     */
+    bool hasKey(const QString &key) const;
+
+    /*!
+     * Returns the value of \a key in the [Desktop Entry] group,
+     * or \a defaultValue if the file doesn't have it or it wasn't asked for.
+     *
+     * Values marked with [$e] are expanded, like KConfigGroup::readEntry() does.
+     */
+    QString value(const QString &key, const QString &defaultValue = QString()) const;
+
+private:
+    friend class KDesktopFile;
+    friend class KDesktopFileIndexPrivate;
+    KCONFIGCORE_NO_EXPORT explicit KDesktopFileRecord(KDesktopFileRecordPrivate *dd);
+
+    QSharedDataPointer<KDesktopFileRecordPrivate> d;
+};
+
+#endif
@@ -0,0 +1,25 @@
+/*
+    This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDESKTOPFILERECORD_P_H
+#define KDESKTOPFILERECORD_P_H
+
+#include <QSharedData>
+#include <QStringList>
+
+class KDesktopFileRecordPrivate : public QSharedData
+{
+public:
+    QString path;
+    // shared by all records read together
+    QStringList keys;
+    // in the order of keys, null for keys the file doesn't have
+    QStringList values;
+    bool valid = false;
+};
+
+#endif // KDESKTOPFILERECORD_P_H
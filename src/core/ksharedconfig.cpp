@@ -12,6 +12,8 @@
 #include "kconfig_p.h"
 #include "kconfiggroup.h"
 #include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
 #include <QThread>
 #include <QThreadStorage>
 
@@ -19,7 +21,33 @@ using namespace Qt::StringLiterals;
 
 void _k_globalMainConfigSyncAndCleanup();
 
-using SharedConfigList = QList<KSharedConfig *>;
+namespace
+{
+// What openConfig() tells shared configs apart by
+struct SharedConfigKey {
+    QString name;
+    KConfig::OpenFlags flags;
+    QStandardPaths::StandardLocation location;
+
+    friend bool operator==(const SharedConfigKey &lhs, const SharedConfigKey &rhs)
+    {
+        return lhs.name == rhs.name && lhs.flags == rhs.flags && lhs.location == rhs.location;
+    }
+
+    friend size_t qHash(const SharedConfigKey &key, size_t seed = 0)
+    {
+        return qHashMulti(seed, key.name, key.flags.toInt(), int(key.location));
+    }
+
+    static SharedConfigKey of(const KSharedConfig *config)
+    {
+        return {config->name(), config->openFlags(), config->locationType()};
+    }
+};
+} // namespace
+
+// The shared configs don't hold a reference to themselves, they remove themselves when they are deleted
+using SharedConfigRegistry = QHash<SharedConfigKey, KSharedConfig *>;
 
 class GlobalSharedConfig
 {
@@ -36,10 +64,13 @@ public:
         // the thread exits.
     }
 
-    SharedConfigList configList;
-    // in addition to the list, we need to hold the main config,
+    SharedConfigRegistry configs;
+    // in addition to the registry, we need to hold the main config,
     // so that it's not created and destroyed all the time.
     KSharedConfigPtr mainConfig;
+    // what KConfig::mainConfigName() depended on when mainConfig was opened
+    QString mainConfigAppName;
+    quint64 mainConfigNameSerial = 0;
     bool wasTestModeEnabled;
 };
 
@@ -61,34 +92,34 @@ static GlobalSharedConfig *globalSharedConfig()
 
 namespace
 {
-[[nodiscard]] QString migrateStateRc(const QString &fileName)
-{
-    // Migrate from an old legacy path to new spec compliant ~/.local/state/
-    // https://gitlab.freedesktop.org/xdg/xdg-specs/-/blob/master/basedir/basedir-spec.xml
-    // TODO KF7: refactor openStateConfig so it always opens from XDG_STATE_HOME instead of the legacy when on an XDG platform
-
-    if (QFileInfo(fileName).isAbsolute()) {
-        return fileName;
-    }
+// The paths of the state configs of this process, by state directory and file name. Once a file is
+// in the state directory, or there was no legacy file for it, there is no need to look again: legacy
+// files aren't written anymore, so none can show up while the process runs.
+struct StateRcPaths {
+    QMutex mutex;
+    QHash<std::pair<QString, QString>, QString> paths;
+};
+Q_GLOBAL_STATIC(StateRcPaths, s_stateRcPaths)
 
-    const QString xdgStateHome = QStandardPaths::writableLocation(QStandardPaths::GenericStateLocation);
-    if (fileName.startsWith(xdgStateHome)) [[unlikely]] {
-        return fileName;
+// Returns the path of fileName in xdgStateHome, migrating it from the legacy location if needed.
+// isFinal is set to whether looking again can't change anything, i.e. the file is in xdgStateHome
+// now or there is no legacy file. It's false if migrating failed, so that it's tried again.
+[[nodiscard]] QString migrateLegacyStateRc(const QString &fileName, const QString &xdgStateHome, bool *isFinal)
+{
+    QString newPath = xdgStateHome + '/'_L1 + fileName; // intentionally not const so it can be move returned
+    // Already migrated, or written in the new location right away. A legacy file that is still around is left alone.
+    if (QFile::exists(newPath)) {
+        *isFinal = true;
+        return newPath;
     }
 
-    QString newPath = xdgStateHome + '/'_L1 + fileName; // intentionally not const so it can be move returned
     QString oldPath = QStandardPaths::locate(QStandardPaths::AppDataLocation, fileName);
     if (oldPath.isEmpty()) { // nothing to migrate
-        return newPath;
-    }
-    if (QFile::exists(oldPath) && QFile::exists(newPath)) {
-        qCDebug(KCONFIG_CORE_LOG) << "Old staterc and new staterc found. Not migrating! Using new path" << newPath;
+        *isFinal = true;
         return newPath;
     }
 
-    if (QFile::exists(newPath)) { // already migrated
-        return newPath;
-    }
+    *isFinal = false;
 
     // Migrate legacy files.
     // On failure we return the new path because we want higher level technology to surface the new path for read/write errors.
@@ -104,8 +135,43 @@ namespace
         return newPath;
     }
 
+    *isFinal = true;
     return newPath;
 }
+
+[[nodiscard]] QString migrateStateRc(const QString &fileName)
+{
+    // Migrate from an old legacy path to new spec compliant ~/.local/state/
+    // https://gitlab.freedesktop.org/xdg/xdg-specs/-/blob/master/basedir/basedir-spec.xml
+    // TODO KF7: refactor openStateConfig so it always opens from XDG_STATE_HOME instead of the legacy when on an XDG platform
+
+    if (QFileInfo(fileName).isAbsolute()) {
+        return fileName;
+    }
+
+    const QString xdgStateHome = QStandardPaths::writableLocation(QStandardPaths::GenericStateLocation);
+    if (fileName.startsWith(xdgStateHome)) [[unlikely]] {
+        return fileName;
+    }
+
+    StateRcPaths *cache = s_stateRcPaths();
+    std::pair<QString, QString> key(xdgStateHome, fileName);
+    {
+        QMutexLocker locker(&cache->mutex);
+        const auto it = cache->paths.constFind(key);
+        if (it != cache->paths.cend()) {
+            return it.value();
+        }
+    }
+
+    bool isFinal = false;
+    QString path = migrateLegacyStateRc(fileName, xdgStateHome, &isFinal);
+    if (isFinal) {
+        QMutexLocker locker(&cache->mutex);
+        cache->paths.insert(std::move(key), path);
+    }
+    return path;
+}
 } // namespace
 
 void _k_globalMainConfigSyncAndCleanup()
@@ -131,29 +197,37 @@ void _k_globalMainConfigSyncAndCleanup()
 
 KSharedConfigPtr KSharedConfig::openConfig(const QString &_fileName, OpenFlags flags, QStandardPaths::StandardLocation resType)
 {
-    QString fileName(_fileName);
     GlobalSharedConfig *global = globalSharedConfig();
-    if (fileName.isEmpty() && !flags.testFlag(KConfig::SimpleConfig)) {
-        // Determine the config file name that KConfig will make up (see KConfigPrivate::changeFileName)
-        fileName = KConfig::mainConfigName();
-    }
 
     if (!global->wasTestModeEnabled && QStandardPaths::isTestModeEnabled()) {
         global->wasTestModeEnabled = true;
-        global->configList.clear();
+        global->configs.clear();
         global->mainConfig = nullptr;
     }
 
-    for (auto *cfg : std::as_const(global->configList)) {
-        if (cfg->name() == fileName && cfg->d_ptr->openFlags == flags && cfg->locationType() == resType) {
-            return KSharedConfigPtr(cfg);
-        }
+    const bool isMainConfig = _fileName.isEmpty() && flags == FullConfig && resType == QStandardPaths::GenericConfigLocation;
+    if (isMainConfig && global->mainConfig && global->mainConfigNameSerial == KConfigPrivate::mainConfigNameSerial()
+        && global->mainConfigAppName == QCoreApplication::applicationName()) {
+        // the main config name can't have changed, no need to make it up again
+        return global->mainConfig;
+    }
+
+    QString fileName(_fileName);
+    if (fileName.isEmpty() && !flags.testFlag(KConfig::SimpleConfig)) {
+        // Determine the config file name that KConfig will make up (see KConfigPrivate::changeFileName)
+        fileName = KConfig::mainConfigName();
+    }
+
+    if (KSharedConfig *cfg = global->configs.value(SharedConfigKey{fileName, flags, resType})) {
+        return KSharedConfigPtr(cfg);
     }
 
     KSharedConfigPtr ptr(new KSharedConfig(fileName, flags, resType));
 
-    if (_fileName.isEmpty() && flags == FullConfig && resType == QStandardPaths::GenericConfigLocation) {
+    if (isMainConfig) {
         global->mainConfig = ptr;
+        global->mainConfigAppName = QCoreApplication::applicationName();
+        global->mainConfigNameSerial = KConfigPrivate::mainConfigNameSerial();
 
         const bool isMainThread = !qApp || QThread::currentThread() == qApp->thread();
         static bool userWarned = false;
@@ -185,13 +259,19 @@ KSharedConfig::Ptr KSharedConfig::openStateConfig(const QString &_fileName)
 KSharedConfig::KSharedConfig(const QString &fileName, OpenFlags flags, QStandardPaths::StandardLocation resType)
     : KConfig(fileName, flags, resType)
 {
-    globalSharedConfig()->configList.append(this);
+    // registered with the name and flags KConfig ended up with, e.g. the canonical path of an absolute file name
+    globalSharedConfig()->configs.insert(SharedConfigKey::of(this), this);
 }
 
 KSharedConfig::~KSharedConfig()
 {
     if (s_storage.hasLocalData()) {
-        globalSharedConfig()->configList.removeAll(this);
+        SharedConfigRegistry &configs = globalSharedConfig()->configs;
+        // after test mode was enabled another config may have taken the place of this one
+        const auto it = configs.constFind(SharedConfigKey::of(this));
+        if (it != configs.cend() && it.value() == this) {
+            configs.erase(it);
+        }
     }
 }
 
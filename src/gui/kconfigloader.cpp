@@ -8,37 +8,108 @@
 #include "kconfigloader_p.h"
 #include "kconfigloaderhandler_p.h"
 
+#include <QCache>
 #include <QColor>
+#include <QCryptographicHash>
 #include <QFont>
-#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QUrl>
 
 #include <QDebug>
 
+namespace
+{
+// A process usually uses a handful of distinct schemas, the limit only guards against unbounded growth
+constexpr qsizetype s_maxCachedSchemas = 128;
+
+struct SchemaCache {
+    QMutex mutex;
+    // keyed by a hash of the XML, evicts the least recently used schema once full
+    QCache<QByteArray, std::shared_ptr<const ConfigLoaderSchema>> schemas{s_maxCachedSchemas};
+};
+Q_GLOBAL_STATIC(SchemaCache, s_schemaCache)
+}
+
+std::shared_ptr<const ConfigLoaderSchema> ConfigLoaderSchema::fromXml(QIODevice *xml)
+{
+    if (!xml->open(QIODevice::ReadOnly)) {
+        qWarning() << "Impossible to open device";
+        return nullptr;
+    }
+    const QByteArray data = xml->readAll();
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    SchemaCache *cache = s_schemaCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        if (const auto *schema = cache->schemas.object(hash)) {
+            return *schema;
+        }
+    }
+
+    auto schema = std::make_shared<ConfigLoaderSchema>();
+    ConfigLoaderHandler handler(schema.get());
+    handler.parse(data);
+
+    QMutexLocker locker(&cache->mutex);
+    cache->schemas.insert(hash, new std::shared_ptr<const ConfigLoaderSchema>(schema));
+    return schema;
+}
+
 void ConfigLoaderPrivate::parse(KConfigLoader *loader, QIODevice *xml)
 {
     clearData();
     loader->clearItems();
 
     if (xml) {
-        ConfigLoaderHandler handler(loader, this);
-        handler.parse(xml);
+        if (const auto schema = ConfigLoaderSchema::fromXml(xml)) {
+            createItems(loader, *schema);
+        }
     }
 }
 
-ConfigLoaderHandler::ConfigLoaderHandler(KConfigLoader *config, ConfigLoaderPrivate *d)
-    : m_config(config)
-    , d(d)
+void ConfigLoaderPrivate::createItems(KConfigLoader *loader, const ConfigLoaderSchema &schema)
+{
+    auto groupName = [this](const QString &group) -> QString {
+        if (group.isEmpty()) {
+            return baseGroup;
+        }
+        if (baseGroup.isEmpty()) {
+            return group;
+        }
+        return baseGroup + QLatin1Char('\x1d') + group;
+    };
+
+    for (const QString &group : schema.groupElements) {
+        if (!group.isEmpty()) {
+            groups.append(group);
+        }
+    }
+
+    int currentGroupElement = -1;
+    for (const ConfigLoaderEntry &entry : schema.entries) {
+        if (entry.groupElement != currentGroupElement) {
+            currentGroupElement = entry.groupElement;
+            loader->setCurrentGroup(groupName(schema.groupElements.at(currentGroupElement)));
+        }
+        addItem(loader, entry);
+    }
+
+    // leave the loader in the last group of the schema, as parsing it did
+    if (!schema.groupElements.isEmpty() && currentGroupElement != schema.groupElements.size() - 1) {
+        loader->setCurrentGroup(groupName(schema.groupElements.constLast()));
+    }
+}
+
+ConfigLoaderHandler::ConfigLoaderHandler(ConfigLoaderSchema *schema)
+    : m_schema(schema)
 {
     resetState();
 }
 
-bool ConfigLoaderHandler::parse(QIODevice *input)
+bool ConfigLoaderHandler::parse(const QByteArray &input)
 {
-    if (!input->open(QIODevice::ReadOnly)) {
-        qWarning() << "Impossible to open device";
-        return false;
-    }
     QXmlStreamReader reader(input);
 
     while (!reader.atEnd()) {
@@ -88,18 +159,7 @@ void ConfigLoaderHandler::startElement(const QStringView localName, const QXmlSt
                 group = attr.value().toString();
             }
         }
-        if (group.isEmpty()) {
-            group = d->baseGroup;
-        } else {
-            d->groups.append(group);
-            if (!d->baseGroup.isEmpty()) {
-                group = d->baseGroup + QLatin1Char('\x1d') + group;
-            }
-        }
-
-        if (m_config) {
-            m_config->setCurrentGroup(group);
-        }
+        m_schema->groupElements.append(group);
     } else if (caseInsensitiveCompare(localName, QLatin1String("entry"))) {
         for (const auto &attr : attrs) {
             const auto attrName = attr.name();
@@ -129,7 +189,7 @@ void ConfigLoaderHandler::endElement(const QStringView localName)
 {
     //     qDebug() << "ConfigLoaderHandler::endElement(" << localName << qName;
     if (caseInsensitiveCompare(localName, QLatin1String("entry"))) {
-        addItem();
+        addEntry();
         resetState();
     } else if (caseInsensitiveCompare(localName, QLatin1String("label"))) {
         if (m_inChoice) {
@@ -157,7 +217,7 @@ void ConfigLoaderHandler::endElement(const QStringView localName)
     m_cdata.clear();
 }
 
-void ConfigLoaderHandler::addItem()
+void ConfigLoaderHandler::addEntry()
 {
     if (m_name.isEmpty()) {
         if (m_key.isEmpty()) {
@@ -169,172 +229,190 @@ void ConfigLoaderHandler::addItem()
 
     m_name.remove(QLatin1Char(' '));
 
+    ConfigLoaderEntry entry;
+    entry.name = std::move(m_name);
+    entry.key = std::move(m_key);
+    entry.type = std::move(m_type);
+    entry.label = std::move(m_label);
+    entry.whatsThis = std::move(m_whatsThis);
+    entry.defaultValue = std::move(m_default);
+    entry.choices = std::move(m_enumChoices);
+    entry.groupElement = m_schema->groupElements.size() - 1;
+    entry.min = m_min;
+    entry.max = m_max;
+    entry.haveMin = m_haveMin;
+    entry.haveMax = m_haveMax;
+    m_schema->entries.append(std::move(entry));
+}
+
+void ConfigLoaderPrivate::addItem(KConfigLoader *loader, const ConfigLoaderEntry &entry)
+{
     KConfigSkeletonItem *item = nullptr;
 
-    if (m_type == QLatin1String("bool")) {
-        const bool defaultValue = caseInsensitiveCompare(m_default, QLatin1String("true"));
-        item = m_config->addItemBool(m_name, *d->newBool(), defaultValue, m_key);
-    } else if (m_type == QLatin1String("color")) {
-        item = m_config->addItemColor(m_name, *d->newColor(), QColor(m_default), m_key);
-    } else if (m_type == QLatin1String("datetime")) {
-        item = m_config->addItemDateTime(m_name, *d->newDateTime(), QDateTime::fromString(m_default), m_key);
-    } else if (m_type == QLatin1String("time")) {
-        item = m_config->addItemTime(m_name, *d->newTime(), QTime::fromString(m_default), m_key);
-    } else if (m_type == QLatin1String("enum")) {
-        m_key = (m_key.isEmpty()) ? m_name : m_key;
+    if (entry.type == QLatin1String("bool")) {
+        const bool defaultValue = caseInsensitiveCompare(entry.defaultValue, QLatin1String("true"));
+        item = loader->addItemBool(entry.name, *newBool(), defaultValue, entry.key);
+    } else if (entry.type == QLatin1String("color")) {
+        item = loader->addItemColor(entry.name, *newColor(), QColor(entry.defaultValue), entry.key);
+    } else if (entry.type == QLatin1String("datetime")) {
+        item = loader->addItemDateTime(entry.name, *newDateTime(), QDateTime::fromString(entry.defaultValue), entry.key);
+    } else if (entry.type == QLatin1String("time")) {
+        item = loader->addItemTime(entry.name, *newTime(), QTime::fromString(entry.defaultValue), entry.key);
+    } else if (entry.type == QLatin1String("enum")) {
+        const QString key = entry.key.isEmpty() ? entry.name : entry.key;
 
         bool ok = false;
-        int defaultValue = m_default.toInt(&ok);
+        int defaultValue = entry.defaultValue.toInt(&ok);
         if (!ok) {
-            for (int i = 0; i < m_enumChoices.size(); i++) {
-                if (m_default == m_enumChoices[i].name) {
+            for (int i = 0; i < entry.choices.size(); i++) {
+                if (entry.defaultValue == entry.choices[i].name) {
                     defaultValue = i;
                     break;
                 }
             }
         }
 
-        KConfigSkeleton::ItemEnum *enumItem = new KConfigSkeleton::ItemEnum(m_config->currentGroup(), m_key, *d->newInt(), m_enumChoices, defaultValue);
-        m_config->addItem(enumItem, m_name);
+        KConfigSkeleton::ItemEnum *enumItem = new KConfigSkeleton::ItemEnum(loader->currentGroup(), key, *newInt(), entry.choices, defaultValue);
+        loader->addItem(enumItem, entry.name);
         item = enumItem;
-    } else if (m_type == QLatin1String("font")) {
-        item = m_config->addItemFont(m_name, *d->newFont(), QFont(m_default), m_key);
-    } else if (m_type == QLatin1String("int")) {
-        KConfigSkeleton::ItemInt *intItem = m_config->addItemInt(m_name, *d->newInt(), m_default.toInt(), m_key);
+    } else if (entry.type == QLatin1String("font")) {
+        item = loader->addItemFont(entry.name, *newFont(), QFont(entry.defaultValue), entry.key);
+    } else if (entry.type == QLatin1String("int")) {
+        KConfigSkeleton::ItemInt *intItem = loader->addItemInt(entry.name, *newInt(), entry.defaultValue.toInt(), entry.key);
 
-        if (m_haveMin) {
-            intItem->setMinValue(m_min);
+        if (entry.haveMin) {
+            intItem->setMinValue(entry.min);
         }
 
-        if (m_haveMax) {
-            intItem->setMaxValue(m_max);
+        if (entry.haveMax) {
+            intItem->setMaxValue(entry.max);
         }
 
         item = intItem;
-    } else if (m_type == QLatin1String("password")) {
-        item = m_config->addItemPassword(m_name, *d->newString(), m_default, m_key);
-    } else if (m_type == QLatin1String("path")) {
-        item = m_config->addItemPath(m_name, *d->newString(), m_default, m_key);
-    } else if (m_type == QLatin1String("string")) {
-        item = m_config->addItemString(m_name, *d->newString(), m_default, m_key);
-    } else if (m_type == QLatin1String("stringlist")) {
+    } else if (entry.type == QLatin1String("password")) {
+        item = loader->addItemPassword(entry.name, *newString(), entry.defaultValue, entry.key);
+    } else if (entry.type == QLatin1String("path")) {
+        item = loader->addItemPath(entry.name, *newString(), entry.defaultValue, entry.key);
+    } else if (entry.type == QLatin1String("string")) {
+        item = loader->addItemString(entry.name, *newString(), entry.defaultValue, entry.key);
+    } else if (entry.type == QLatin1String("stringlist")) {
         // FIXME: the split() is naive and will break on lists with ,'s in them
         // empty parts are not wanted in this case
-        item = m_config->addItemStringList(m_name, *d->newStringList(), m_default.split(QLatin1Char(','), Qt::SkipEmptyParts), m_key);
-    } else if (m_type == QLatin1String("uint")) {
-        KConfigSkeleton::ItemUInt *uintItem = m_config->addItemUInt(m_name, *d->newUint(), m_default.toUInt(), m_key);
-        if (m_haveMin) {
-            uintItem->setMinValue(m_min);
+        item = loader->addItemStringList(entry.name, *newStringList(), entry.defaultValue.split(QLatin1Char(','), Qt::SkipEmptyParts), entry.key);
+    } else if (entry.type == QLatin1String("uint")) {
+        KConfigSkeleton::ItemUInt *uintItem = loader->addItemUInt(entry.name, *newUint(), entry.defaultValue.toUInt(), entry.key);
+        if (entry.haveMin) {
+            uintItem->setMinValue(entry.min);
         }
-        if (m_haveMax) {
-            uintItem->setMaxValue(m_max);
+        if (entry.haveMax) {
+            uintItem->setMaxValue(entry.max);
         }
         item = uintItem;
-    } else if (m_type == QLatin1String("url")) {
-        m_key = (m_key.isEmpty()) ? m_name : m_key;
-        KConfigSkeleton::ItemUrl *urlItem = new KConfigSkeleton::ItemUrl(m_config->currentGroup(), m_key, *d->newUrl(), QUrl::fromUserInput(m_default));
-        m_config->addItem(urlItem, m_name);
+    } else if (entry.type == QLatin1String("url")) {
+        const QString key = entry.key.isEmpty() ? entry.name : entry.key;
+        KConfigSkeleton::ItemUrl *urlItem = new KConfigSkeleton::ItemUrl(loader->currentGroup(), key, *newUrl(), QUrl::fromUserInput(entry.defaultValue));
+        loader->addItem(urlItem, entry.name);
         item = urlItem;
-    } else if (m_type == QLatin1String("double")) {
-        KConfigSkeleton::ItemDouble *doubleItem = m_config->addItemDouble(m_name, *d->newDouble(), m_default.toDouble(), m_key);
-        if (m_haveMin) {
-            doubleItem->setMinValue(m_min);
+    } else if (entry.type == QLatin1String("double")) {
+        KConfigSkeleton::ItemDouble *doubleItem = loader->addItemDouble(entry.name, *newDouble(), entry.defaultValue.toDouble(), entry.key);
+        if (entry.haveMin) {
+            doubleItem->setMinValue(entry.min);
         }
-        if (m_haveMax) {
-            doubleItem->setMaxValue(m_max);
+        if (entry.haveMax) {
+            doubleItem->setMaxValue(entry.max);
         }
         item = doubleItem;
-    } else if (m_type == QLatin1String("intlist")) {
+    } else if (entry.type == QLatin1String("intlist")) {
         QList<int> defaultList;
-        const QList<QStringView> tmpList = QStringView(m_default).split(QLatin1Char(','), Qt::SkipEmptyParts);
+        const QList<QStringView> tmpList = QStringView(entry.defaultValue).split(QLatin1Char(','), Qt::SkipEmptyParts);
         for (const QStringView tmp : tmpList) {
             defaultList.append(tmp.toInt());
         }
-        item = m_config->addItemIntList(m_name, *d->newIntList(), defaultList, m_key);
-    } else if (m_type == QLatin1String("longlong")) {
-        KConfigSkeleton::ItemLongLong *longlongItem = m_config->addItemLongLong(m_name, *d->newLongLong(), m_default.toLongLong(), m_key);
-        if (m_haveMin) {
-            longlongItem->setMinValue(m_min);
+        item = loader->addItemIntList(entry.name, *newIntList(), defaultList, entry.key);
+    } else if (entry.type == QLatin1String("longlong")) {
+        KConfigSkeleton::ItemLongLong *longlongItem = loader->addItemLongLong(entry.name, *newLongLong(), entry.defaultValue.toLongLong(), entry.key);
+        if (entry.haveMin) {
+            longlongItem->setMinValue(entry.min);
         }
-        if (m_haveMax) {
-            longlongItem->setMaxValue(m_max);
+        if (entry.haveMax) {
+            longlongItem->setMaxValue(entry.max);
         }
         item = longlongItem;
         /* No addItemPathList in KConfigSkeleton ?
-        } else if (m_type == "PathList") {
+        } else if (entry.type == "PathList") {
             //FIXME: the split() is naive and will break on lists with ,'s in them
-            item = m_config->addItemPathList(m_name, *d->newStringList(), m_default.split(","), m_key);
+            item = loader->addItemPathList(entry.name, *newStringList(), entry.defaultValue.split(","), entry.key);
         */
-    } else if (m_type == QLatin1String("point")) {
+    } else if (entry.type == QLatin1String("point")) {
         QPoint defaultPoint;
-        const QList<QStringView> tmpList = QStringView(m_default).split(QLatin1Char(','));
+        const QList<QStringView> tmpList = QStringView(entry.defaultValue).split(QLatin1Char(','));
         if (tmpList.size() >= 2) {
             defaultPoint.setX(tmpList[0].toInt());
             defaultPoint.setY(tmpList[1].toInt());
         }
-        item = m_config->addItemPoint(m_name, *d->newPoint(), defaultPoint, m_key);
-    } else if (m_type == QLatin1String("pointf")) {
+        item = loader->addItemPoint(entry.name, *newPoint(), defaultPoint, entry.key);
+    } else if (entry.type == QLatin1String("pointf")) {
         QPointF defaultPointF;
-        const auto tmpList = QStringView(m_default).split(u',');
+        const auto tmpList = QStringView(entry.defaultValue).split(u',');
         if (tmpList.size() >= 2) {
             defaultPointF.setX(tmpList[0].toDouble());
             defaultPointF.setY(tmpList[1].toDouble());
         }
-        item = m_config->addItemPointF(m_name, *d->newPointF(), defaultPointF, m_key);
-    } else if (m_type == QLatin1String("rect")) {
+        item = loader->addItemPointF(entry.name, *newPointF(), defaultPointF, entry.key);
+    } else if (entry.type == QLatin1String("rect")) {
         QRect defaultRect;
-        const QList<QStringView> tmpList = QStringView(m_default).split(QLatin1Char(','));
+        const QList<QStringView> tmpList = QStringView(entry.defaultValue).split(QLatin1Char(','));
         if (tmpList.size() >= 4) {
             defaultRect.setCoords(tmpList[0].toInt(), tmpList[1].toInt(), tmpList[2].toInt(), tmpList[3].toInt());
         }
-        item = m_config->addItemRect(m_name, *d->newRect(), defaultRect, m_key);
-    } else if (m_type == QLatin1String("rectf")) {
+        item = loader->addItemRect(entry.name, *newRect(), defaultRect, entry.key);
+    } else if (entry.type == QLatin1String("rectf")) {
         QRectF defaultRectF;
-        const auto tmpList = QStringView(m_default).split(u',');
+        const auto tmpList = QStringView(entry.defaultValue).split(u',');
         if (tmpList.size() >= 4) {
             defaultRectF.setCoords(tmpList[0].toDouble(), tmpList[1].toDouble(), tmpList[2].toDouble(), tmpList[3].toDouble());
         }
-        item = m_config->addItemRectF(m_name, *d->newRectF(), defaultRectF, m_key);
-    } else if (m_type == QLatin1String("size")) {
+        item = loader->addItemRectF(entry.name, *newRectF(), defaultRectF, entry.key);
+    } else if (entry.type == QLatin1String("size")) {
         QSize defaultSize;
-        const QList<QStringView> tmpList = QStringView(m_default).split(QLatin1Char(','));
+        const QList<QStringView> tmpList = QStringView(entry.defaultValue).split(QLatin1Char(','));
         if (tmpList.size() >= 2) {
             defaultSize.setWidth(tmpList[0].toInt());
             defaultSize.setHeight(tmpList[1].toInt());
         }
-        item = m_config->addItemSize(m_name, *d->newSize(), defaultSize, m_key);
-    } else if (m_type == QLatin1String("sizef")) {
+        item = loader->addItemSize(entry.name, *newSize(), defaultSize, entry.key);
+    } else if (entry.type == QLatin1String("sizef")) {
         QSizeF defaultSizeF;
-        const auto tmpList = QStringView(m_default).split(u',');
+        const auto tmpList = QStringView(entry.defaultValue).split(u',');
         if (tmpList.size() >= 2) {
             defaultSizeF.setWidth(tmpList[0].toDouble());
             defaultSizeF.setHeight(tmpList[1].toDouble());
         }
-        item = m_config->addItemSizeF(m_name, *d->newSizeF(), defaultSizeF, m_key);
-    } else if (m_type == QLatin1String("ulonglong")) {
-        KConfigSkeleton::ItemULongLong *ulonglongItem = m_config->addItemULongLong(m_name, *d->newULongLong(), m_default.toULongLong(), m_key);
-        if (m_haveMin) {
-            ulonglongItem->setMinValue(m_min);
+        item = loader->addItemSizeF(entry.name, *newSizeF(), defaultSizeF, entry.key);
+    } else if (entry.type == QLatin1String("ulonglong")) {
+        KConfigSkeleton::ItemULongLong *ulonglongItem = loader->addItemULongLong(entry.name, *newULongLong(), entry.defaultValue.toULongLong(), entry.key);
+        if (entry.haveMin) {
+            ulonglongItem->setMinValue(entry.min);
         }
-        if (m_haveMax) {
-            ulonglongItem->setMaxValue(m_max);
+        if (entry.haveMax) {
+            ulonglongItem->setMaxValue(entry.max);
         }
         item = ulonglongItem;
         /* No addItemUrlList in KConfigSkeleton ?
-        } else if (m_type == "urllist") {
+        } else if (entry.type == "urllist") {
             //FIXME: the split() is naive and will break on lists with ,'s in them
-            QStringList tmpList = m_default.split(",");
+            QStringList tmpList = entry.defaultValue.split(",");
             QList<QUrl> defaultList;
             foreach (const QString& tmp, tmpList) {
                 defaultList.append(QUrl(tmp));
             }
-            item = m_config->addItemUrlList(m_name, *d->newUrlList(), defaultList, m_key);*/
+            item = loader->addItemUrlList(entry.name, *newUrlList(), defaultList, entry.key);*/
     }
 
     if (item) {
-        item->setLabel(m_label);
-        item->setWhatsThis(m_whatsThis);
-        d->keysToNames.insert(item->group() + item->key(), item->name());
+        item->setLabel(entry.label);
+        item->setWhatsThis(entry.whatsThis);
+        keysToNames.insert(item->group() + item->key(), item->name());
     }
 }
 
@@ -9,6 +9,39 @@
 
 #include <QUrl>
 
+#include <memory>
+
+/*
+ * One <entry> of a schema, as read from the XML.
+ */
+struct ConfigLoaderEntry {
+    QString name;
+    QString key;
+    QString type;
+    QString label;
+    QString whatsThis;
+    QString defaultValue;
+    QList<KConfigSkeleton::ItemEnum::Choice> choices;
+    // index into ConfigLoaderSchema::groupElements, -1 for entries before the first <group>
+    int groupElement = -1;
+    int min = 0;
+    int max = 0;
+    bool haveMin = false;
+    bool haveMax = false;
+};
+
+/*
+ * The parsed form of a schema. It doesn't depend on the loader, so the
+ * loaders created from the same XML share it instead of parsing it again.
+ */
+struct ConfigLoaderSchema {
+    // the name attributes of all the <group> elements in order, empty for groups without one
+    QStringList groupElements;
+    QList<ConfigLoaderEntry> entries;
+
+    static std::shared_ptr<const ConfigLoaderSchema> fromXml(QIODevice *xml);
+};
+
 class ConfigLoaderPrivate
 {
 public:
@@ -195,6 +228,8 @@ public:
     }
 
     void parse(KConfigLoader *loader, QIODevice *xml);
+    void createItems(KConfigLoader *loader, const ConfigLoaderSchema &schema);
+    void addItem(KConfigLoader *loader, const ConfigLoaderEntry &entry);
 
     /*!
      * Whether or not to write out default values.
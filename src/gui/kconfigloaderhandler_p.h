@@ -13,19 +13,18 @@
 class ConfigLoaderHandler
 {
 public:
-    ConfigLoaderHandler(KConfigLoader *config, ConfigLoaderPrivate *d);
+    explicit ConfigLoaderHandler(ConfigLoaderSchema *schema);
 
-    bool parse(QIODevice *input);
+    bool parse(const QByteArray &input);
 
     void startElement(const QStringView localName, const QXmlStreamAttributes &attrs);
     void endElement(const QStringView localName);
 
 private:
-    void addItem();
+    void addEntry();
     void resetState();
 
-    KConfigLoader *m_config;
-    ConfigLoaderPrivate *d;
+    ConfigLoaderSchema *m_schema;
     int m_min;
     int m_max;
     QString m_name;
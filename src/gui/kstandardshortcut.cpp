@@ -17,7 +17,9 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QHash>
 #include <QKeySequence>
+#include <QSet>
 
 namespace KStandardShortcut
 {
@@ -531,6 +533,19 @@ static KStandardShortcutInfo *guardedStandardShortcutInfo(StandardShortcut id)
     }
 }
 
+/* Maps every key sequence of the standard shortcuts to the first shortcut using it,
+    the one a walk over g_infoStandardShortcut would find. It is built on the first
+    call to find() and thrown away whenever a shortcut changes.
+*/
+// clazy:exclude-next-line=non-pod-global-static
+static QHash<QKeySequence, StandardShortcut> g_standardShortcutBySequence;
+static bool g_standardShortcutBySequenceValid = false;
+
+static void invalidateSequenceIndex()
+{
+    g_standardShortcutBySequenceValid = false;
+}
+
 // Sanitize the list for duplicates. For some reason some
 // people have kdeglobals entries like
 //   Close=Ctrl+W; Ctrl+Esc; Ctrl+W; Ctrl+Esc;
@@ -538,14 +553,34 @@ static KStandardShortcutInfo *guardedStandardShortcutInfo(StandardShortcut id)
 // declaration is clearly bogus so fix it
 static void sanitizeShortcutList(QList<QKeySequence> *list)
 {
-    for (int i = 0; i < list->size(); ++i) {
-        const QKeySequence &ks = list->at(i);
-        int other = list->indexOf(ks, i + 1);
-        while (other != -1) {
-            list->removeAt(other);
-            other = list->indexOf(ks, other);
+    QSet<QKeySequence> seen;
+    seen.reserve(list->size());
+    list->removeIf([&seen](const QKeySequence &ks) {
+        if (seen.contains(ks)) {
+            return true;
+        }
+        seen.insert(ks);
+        return false;
+    });
+}
+
+/* Set the shortcut of @p info from the value @p configured in the [Shortcuts] group,
+    or from the default if @p configured is null because there is no such entry.
+*/
+static void applyConfiguredShortcut(KStandardShortcutInfo *info, const QString *configured)
+{
+    if (configured) {
+        if (*configured != QLatin1String("none")) {
+            info->cut = QKeySequence::listFromString(*configured);
+            sanitizeShortcutList(&info->cut);
+        } else {
+            info->cut = QList<QKeySequence>();
         }
+    } else {
+        info->cut = hardcodedDefaultShortcut(info->id);
     }
+
+    info->isInitialized = true;
 }
 
 /* Initialize the accelerator @p id by checking if it is overridden
@@ -567,18 +602,33 @@ void initialize(StandardShortcut id)
     KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("Shortcuts"));
 
     if (cg.hasKey(info->name)) {
-        QString s = cg.readEntry(info->name);
-        if (s != QLatin1String("none")) {
-            info->cut = QKeySequence::listFromString(s);
-            sanitizeShortcutList(&info->cut);
-        } else {
-            info->cut = QList<QKeySequence>();
-        }
+        const QString s = cg.readEntry(info->name);
+        applyConfiguredShortcut(info, &s);
     } else {
-        info->cut = hardcodedDefaultShortcut(id);
+        applyConfiguredShortcut(info, nullptr);
     }
 
-    info->isInitialized = true;
+    invalidateSequenceIndex();
+}
+
+/* Initialize all the accelerators that aren't yet, like initialize() does,
+    reading the [Shortcuts] group only once. Used on the first access to any
+    of them, since applications using standard actions access many at startup.
+*/
+static void initializeAll()
+{
+    const KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("Shortcuts"));
+    const QMap<QString, QString> configured = cg.entryMap();
+
+    for (KStandardShortcutInfo &info : g_infoStandardShortcut) {
+        if (info.isInitialized || info.id == AccelNone) {
+            continue;
+        }
+        const auto it = configured.constFind(QString::fromLatin1(info.name));
+        applyConfiguredShortcut(&info, it != configured.cend() ? &it.value() : nullptr);
+    }
+
+    invalidateSequenceIndex();
 }
 
 void saveShortcut(StandardShortcut id, const QList<QKeySequence> &newShortcut)
@@ -593,6 +643,7 @@ void saveShortcut(StandardShortcut id, const QList<QKeySequence> &newShortcut)
     KConfigGroup cg(KSharedConfig::openConfig(), QStringLiteral("Shortcuts"));
 
     info->cut = newShortcut;
+    invalidateSequenceIndex();
     bool sameAsDefault = (newShortcut == hardcodedDefaultShortcut(id));
 
     if (sameAsDefault) {
@@ -638,38 +689,59 @@ const QList<QKeySequence> &shortcut(StandardShortcut id)
     KStandardShortcutInfo *info = guardedStandardShortcutInfo(id);
 
     if (!info->isInitialized) {
-        initialize(id);
+        if (info->id == AccelNone) {
+            initialize(id);
+        } else {
+            initializeAll();
+        }
     }
 
     return info->cut;
 }
 
-StandardShortcut find(const QKeySequence &seq)
+static void rebuildSequenceIndex()
 {
-    if (!seq.isEmpty()) {
-        for (const KStandardShortcutInfo &shortcutInfo : g_infoStandardShortcut) {
-            const StandardShortcut id = shortcutInfo.id;
-            if (id != AccelNone) {
-                if (!shortcutInfo.isInitialized) {
-                    initialize(id);
-                }
-                if (shortcutInfo.cut.contains(seq)) {
-                    return id;
-                }
+    g_standardShortcutBySequence.clear();
+    for (const KStandardShortcutInfo &shortcutInfo : g_infoStandardShortcut) {
+        const StandardShortcut id = shortcutInfo.id;
+        if (id == AccelNone) {
+            continue;
+        }
+        if (!shortcutInfo.isInitialized) {
+            initializeAll();
+        }
+        for (const QKeySequence &seq : shortcutInfo.cut) {
+            if (!seq.isEmpty()) {
+                g_standardShortcutBySequence.tryEmplace(seq, id);
             }
         }
     }
-    return AccelNone;
+    g_standardShortcutBySequenceValid = true;
+}
+
+StandardShortcut find(const QKeySequence &seq)
+{
+    if (seq.isEmpty()) {
+        return AccelNone;
+    }
+    if (!g_standardShortcutBySequenceValid) {
+        rebuildSequenceIndex();
+    }
+    return g_standardShortcutBySequence.value(seq, AccelNone);
 }
 
 StandardShortcut findByName(const QString &name)
 {
-    for (const KStandardShortcutInfo &shortcutInfo : g_infoStandardShortcut) {
-        if (QLatin1StringView(shortcutInfo.name) == name) {
-            return shortcutInfo.id;
+    static const QHash<QString, StandardShortcut> idsByName = [] {
+        QHash<QString, StandardShortcut> ids;
+        for (const KStandardShortcutInfo &shortcutInfo : g_infoStandardShortcut) {
+            if (shortcutInfo.name) {
+                ids.tryEmplace(QString::fromLatin1(shortcutInfo.name), shortcutInfo.id);
+            }
         }
-    }
-    return AccelNone;
+        return ids;
+    }();
+    return idsByName.value(name, AccelNone);
 }
 
 QList<QKeySequence> hardcodedDefaultShortcut(StandardShortcut id)
@@ -15,9 +15,47 @@
 static const char s_initialSizePropertyName[] = "_kconfig_initial_size";
 static const char s_initialScreenSizePropertyName[] = "_kconfig_initial_screen_size";
 
+/* The config keys depend on the screen arrangement, which rarely changes,
+   but they are needed on every save while a window is moved or resized. */
+struct ScreenKeyCache {
+    QString connectedScreens;
+    bool connectedScreensValid = false;
+    bool watchingScreens = false;
+
+    int screenCount = -1;
+    QSize primaryScreenSize;
+    QString keyPrefix;
+};
+
+static ScreenKeyCache &screenKeyCache()
+{
+    static ScreenKeyCache cache;
+    if (!cache.watchingScreens && qGuiApp) {
+        cache.watchingScreens = true;
+        const auto invalidate = []() {
+            screenKeyCache().connectedScreensValid = false;
+        };
+        QObject::connect(qGuiApp, &QGuiApplication::screenAdded, qGuiApp, invalidate);
+        QObject::connect(qGuiApp, &QGuiApplication::screenRemoved, qGuiApp, invalidate);
+        // the connections go away with the application, a new one has to be watched again
+        QObject::connect(qGuiApp, &QObject::destroyed, []() {
+            ScreenKeyCache &cache = screenKeyCache();
+            cache.watchingScreens = false;
+            cache.connectedScreensValid = false;
+            cache.screenCount = -1;
+        });
+    }
+    return cache;
+}
+
 // Convenience function to get a space-separated list of all connected screens
 static QString allConnectedScreens()
 {
+    ScreenKeyCache &cache = screenKeyCache();
+    if (cache.connectedScreensValid) {
+        return cache.connectedScreens;
+    }
+
     QStringList names;
     const auto screens = QGuiApplication::screens();
     names.reserve(screens.length());
@@ -30,7 +68,10 @@ static QString allConnectedScreens()
     // connector order is non-deterministic. We need to sort the list to keep a
     // consistent order and avoid losing multi-screen size and position data.
     names.sort();
-    return names.join(QLatin1Char(' '));
+    cache.connectedScreens = names.join(QLatin1Char(' '));
+    // without an application there are no signals telling about new screens
+    cache.connectedScreensValid = cache.watchingScreens;
+    return cache.connectedScreens;
 }
 
 // Convenience function to return screen by its name from window screen siblings
@@ -54,20 +95,24 @@ static QScreen *findScreenByName(const QWindow *window, const QString screenName
 // save window size, position, or maximization information.
 static QString configFileString(const QString &key)
 {
-    QString returnString;
+    ScreenKeyCache &cache = screenKeyCache();
     const int numberOfScreens = QGuiApplication::screens().length();
+    const QSize primaryScreenSize = numberOfScreens == 1 ? QGuiApplication::primaryScreen()->geometry().size() : QSize();
 
-    if (numberOfScreens == 1) {
-        // For single-screen setups, we save data on a per-resolution basis.
-        const QRect screenGeometry = QGuiApplication::primaryScreen()->geometry();
-        returnString = QStringLiteral("%1x%2 screen: %3").arg(QString::number(screenGeometry.width()), QString::number(screenGeometry.height()), key);
-    } else {
-        // For multi-screen setups, we save data based on the number of screens.
-        // Distinguishing individual screens based on their names is unreliable
-        // due to name strings being inherently volatile.
-        returnString = QStringLiteral("%1 screens: %2").arg(QString::number(numberOfScreens), key);
+    if (numberOfScreens != cache.screenCount || primaryScreenSize != cache.primaryScreenSize) {
+        if (numberOfScreens == 1) {
+            // For single-screen setups, we save data on a per-resolution basis.
+            cache.keyPrefix = QStringLiteral("%1x%2 screen: ").arg(QString::number(primaryScreenSize.width()), QString::number(primaryScreenSize.height()));
+        } else {
+            // For multi-screen setups, we save data based on the number of screens.
+            // Distinguishing individual screens based on their names is unreliable
+            // due to name strings being inherently volatile.
+            cache.keyPrefix = QStringLiteral("%1 screens: ").arg(QString::number(numberOfScreens));
+        }
+        cache.screenCount = numberOfScreens;
+        cache.primaryScreenSize = primaryScreenSize;
     }
-    return returnString;
+    return cache.keyPrefix + key;
 }
 
 // Convenience function for "window is maximized" string
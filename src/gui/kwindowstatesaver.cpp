@@ -7,20 +7,62 @@
 #include "ksharedconfig.h"
 #include "kwindowconfig.h"
 
+#include <QPointer>
 #include <QWindow>
 
 class KWindowStateSaverPrivate
 {
 public:
-    QWindow *window = nullptr;
+    // cleared once the window is being destroyed, which also destroys this saver when it's the parent
+    QPointer<QWindow> window;
     KConfigGroup configGroup;
     std::function<QWindow *()> windowHandleCallback;
     int timerId = 0;
+    int saveTimerId = 0;
+    bool sizeChanged = false;
+    bool positionChanged = false;
 
     void init(KWindowStateSaver *q);
     void initWidget(QObject *widget, KWindowStateSaver *q);
+    void scheduleSave(KWindowStateSaver *q);
+    void savePendingState(KWindowStateSaver *q);
 };
 
+// Geometry changes come in bursts during interactive moves and resizes,
+// they are written to the config group at most this often
+static constexpr std::chrono::milliseconds s_saveInterval(100);
+
+void KWindowStateSaverPrivate::scheduleSave(KWindowStateSaver *q)
+{
+    if (!saveTimerId) {
+        saveTimerId = q->startTimer(s_saveInterval);
+    }
+}
+
+void KWindowStateSaverPrivate::savePendingState(KWindowStateSaver *q)
+{
+    if (saveTimerId) {
+        q->killTimer(saveTimerId);
+        saveTimerId = 0;
+    }
+    if ((!sizeChanged && !positionChanged) || !window) {
+        return;
+    }
+
+    if (sizeChanged) {
+        KWindowConfig::saveWindowSize(window, configGroup);
+    }
+    if (positionChanged) {
+        KWindowConfig::saveWindowPosition(window, configGroup);
+    }
+    sizeChanged = false;
+    positionChanged = false;
+
+    if (!timerId) {
+        timerId = q->startTimer(std::chrono::seconds(30));
+    }
+}
+
 void KWindowStateSaverPrivate::init(KWindowStateSaver *q)
 {
     if (!window) {
@@ -31,16 +73,12 @@ void KWindowStateSaverPrivate::init(KWindowStateSaver *q)
     KWindowConfig::restoreWindowPosition(window, configGroup);
 
     const auto saveSize = [q, this]() {
-        KWindowConfig::saveWindowSize(window, configGroup);
-        if (!timerId) {
-            timerId = q->startTimer(std::chrono::seconds(30));
-        }
+        sizeChanged = true;
+        scheduleSave(q);
     };
     const auto savePosition = [q, this]() {
-        KWindowConfig::saveWindowPosition(window, configGroup);
-        if (!timerId) {
-            timerId = q->startTimer(std::chrono::seconds(30));
-        }
+        positionChanged = true;
+        scheduleSave(q);
     };
 
     QObject::connect(window, &QWindow::windowStateChanged, q, saveSize);
@@ -48,6 +86,12 @@ void KWindowStateSaverPrivate::init(KWindowStateSaver *q)
     QObject::connect(window, &QWindow::heightChanged, q, saveSize);
     QObject::connect(window, &QWindow::xChanged, q, savePosition);
     QObject::connect(window, &QWindow::yChanged, q, savePosition);
+    // the window may be gone before the next save, so don't keep changes waiting once it's hidden
+    QObject::connect(window, &QWindow::visibleChanged, q, [q, this](bool visible) {
+        if (!visible) {
+            savePendingState(q);
+        }
+    });
 }
 
 void KWindowStateSaverPrivate::initWidget(QObject *widget, KWindowStateSaver *q)
@@ -84,11 +128,18 @@ KWindowStateSaver::KWindowStateSaver(QWindow *window, const QString &configGroup
 
 KWindowStateSaver::~KWindowStateSaver()
 {
+    // don't lose a change still waiting for the timer
+    d->savePendingState(this);
     delete d;
 }
 
 void KWindowStateSaver::timerEvent(QTimerEvent *event)
 {
+    if (event->timerId() == d->saveTimerId) {
+        d->savePendingState(this);
+        return;
+    }
+
     killTimer(event->timerId());
     d->configGroup.sync();
     d->timerId = 0;
@@ -9,13 +9,14 @@
 #include <cstdlib>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDate>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QProcess>
 #include <QTemporaryFile>
-#include <QTextStream>
 #include <QUrl>
 
 #include <kconfig.h>
@@ -25,6 +26,8 @@
 #include <QCommandLineParser>
 #include <QStandardPaths>
 
+#include <algorithm>
+
 #include "kconf_update_debug.h"
 
 // Convenience wrapper around qCDebug to prefix the output with metadata of
@@ -41,35 +44,47 @@ public:
     KonfUpdate &operator=(const KonfUpdate &) = delete;
 
     QStringList findUpdateFiles(bool dirtyOnly);
+    QStringList findUpdateFiles(const QStringList &dirs, bool dirtyOnly);
+    static QStringList updateDirs();
+    static QByteArray updateDirsFingerprint(const QStringList &dirs);
 
     bool updateFile(const QString &filename);
 
     void gotId(const QString &_id);
     void gotScript(const QString &_script);
+    void reportScriptTimings() const;
 
 protected:
     /* kconf_updaterc */
     KConfig *m_config;
     QString m_currentFilename;
     bool m_skip = false;
+    // set when the current update id ran a script, whose effects can't be undone
+    bool m_ranScript = false;
     bool m_bTestMode;
     bool m_bDebugOutput;
     QString m_id;
 
     bool m_bUseConfigInfo = false;
+    // set when an update could not be completed and needs to be retried on the next run
+    bool m_bHadFailures = false;
     QStringList m_arguments;
-    QTextStream *m_textStream;
-    QFile *m_file;
     QString m_line;
     int m_lineCount;
+
+    struct ScriptTiming {
+        QString updateFile;
+        QString script;
+        qint64 elapsedMs;
+    };
+    QList<ScriptTiming> m_scriptTimings;
 };
 
 KonfUpdate::KonfUpdate(QCommandLineParser *parser)
-    : m_textStream(nullptr)
-    , m_file(nullptr)
-    , m_lineCount(-1)
+    : m_lineCount(-1)
 {
     bool updateAll = false;
+    QByteArray fingerprint;
 
     m_config = new KConfig(QStringLiteral("kconf_updaterc"));
     KConfigGroup cg(m_config, QString());
@@ -114,13 +129,25 @@ KonfUpdate::KonfUpdate(QCommandLineParser *parser)
         if (cg.readEntry("autoUpdateDisabled", false)) {
             return;
         }
-        updateFiles = findUpdateFiles(true);
+        // If no update file was added, removed or modified since the last complete run there is nothing to do.
+        const QStringList dirs = updateDirs();
+        fingerprint = updateDirsFingerprint(dirs);
+        if (cg.readEntry("updateInfoAdded", false) && cg.readEntry("updateDirsFingerprint", QByteArray()) == fingerprint) {
+            qCDebug(KCONF_UPDATE_LOG) << "No update files changed since the last run";
+            return;
+        }
+        updateFiles = findUpdateFiles(dirs, true);
         updateAll = true;
     }
 
     for (const QString &file : std::as_const(updateFiles)) {
         updateFile(file);
     }
+    reportScriptTimings();
+
+    if (updateAll && !m_bHadFailures) {
+        cg.writeEntry("updateDirsFingerprint", fingerprint);
+    }
 
     if (updateAll && !cg.readEntry("updateInfoAdded", false)) {
         cg.writeEntry("updateInfoAdded", true);
@@ -131,15 +158,42 @@ KonfUpdate::KonfUpdate(QCommandLineParser *parser)
 KonfUpdate::~KonfUpdate()
 {
     delete m_config;
-    delete m_file;
-    delete m_textStream;
+}
+
+QStringList KonfUpdate::updateDirs()
+{
+    return QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("kconf_update"), QStandardPaths::LocateDirectory);
+}
+
+QByteArray KonfUpdate::updateDirsFingerprint(const QStringList &dirs)
+{
+    // The list of directories is part of the fingerprint, so changes to XDG_DATA_DIRS are noticed too.
+    // Update files overwritten in place don't change the mtime of their directory, so the times of every
+    // file are part of it as well; the ctime also changes when e.g. "cp -p" keeps the old mtime.
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &dir : dirs) {
+        hash.addData(QFile::encodeName(dir));
+        hash.addData(QByteArrayView("\0", 1));
+        const QFileInfoList files = QDir(dir).entryInfoList(QStringList(QStringLiteral("*.upd")), QDir::Files, QDir::Name);
+        for (const QFileInfo &info : files) {
+            hash.addData(QFile::encodeName(info.fileName()));
+            hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+            hash.addData(QByteArray::number(info.metadataChangeTime().toMSecsSinceEpoch()));
+            hash.addData(QByteArrayView("\0", 1));
+        }
+    }
+    return hash.result().toHex();
 }
 
 QStringList KonfUpdate::findUpdateFiles(bool dirtyOnly)
+{
+    return findUpdateFiles(updateDirs(), dirtyOnly);
+}
+
+QStringList KonfUpdate::findUpdateFiles(const QStringList &dirs, bool dirtyOnly)
 {
     QStringList result;
 
-    const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("kconf_update"), QStandardPaths::LocateDirectory);
     for (const QString &d : dirs) {
         const QDir dir(d);
 
@@ -180,17 +234,20 @@ bool KonfUpdate::updateFile(const QString &filename)
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning("Could not open update-file '%s'.", qUtf8Printable(filename));
+        m_bHadFailures = true;
         return false;
     }
 
     qCDebug(KCONF_UPDATE_LOG) << "Checking update-file" << filename << "for new updates";
 
-    QTextStream ts(&file);
-    ts.setEncoding(QStringConverter::Encoding::Latin1);
+    // Update files are small, read them in one go instead of line by line
+    const QString content = QString::fromLatin1(file.readAll());
+    file.close();
+
     m_lineCount = 0;
     bool foundVersion = false;
-    while (!ts.atEnd()) {
-        m_line = ts.readLine().trimmed();
+    for (const QStringView line : QStringView(content).split(QLatin1Char('\n'))) {
+        m_line = line.trimmed().toString();
         const QLatin1String versionPrefix("Version=");
         if (m_line.startsWith(versionPrefix)) {
             if (m_line.mid(versionPrefix.length()) == QLatin1Char('6')) {
@@ -250,9 +307,15 @@ void KonfUpdate::gotId(const QString &_id)
         if (!ids.contains(m_id)) {
             ids.append(m_id);
             cg.writeEntry("done", ids);
-            cg.sync();
+            // Usually written out together with the timestamps once the whole update file is done.
+            // After a script ran it is written right away, so that the script doesn't run again
+            // if kconf_update is interrupted before the end of the file.
+            if (m_ranScript) {
+                cg.sync();
+            }
         }
     }
+    m_ranScript = false;
 
     if (_id.isEmpty()) {
         return;
@@ -305,6 +368,7 @@ void KonfUpdate::gotScript(const QString &_script)
         if (path.isEmpty()) {
             qCDebugFile(KCONF_UPDATE_LOG) << "Script" << script << "not found";
             m_skip = true;
+            m_bHadFailures = true;
             return;
         }
     }
@@ -324,6 +388,7 @@ void KonfUpdate::gotScript(const QString &_script)
         if (interpreterPath.isEmpty()) {
             qCDebugFile(KCONF_UPDATE_LOG) << "Cannot find interpreter" << interpreter;
             m_skip = true;
+            m_bHadFailures = true;
             return;
         }
         cmd = interpreterPath;
@@ -340,11 +405,17 @@ void KonfUpdate::gotScript(const QString &_script)
             qCDebug(KCONF_UPDATE_LOG) << "Script contents is:\n" << scriptFile.readAll();
         }
     }
+    QElapsedTimer timer;
+    timer.start();
     QProcess proc;
+    m_ranScript = true;
     proc.start(cmd, args);
-    if (!proc.waitForFinished(60000)) {
+    const bool finished = proc.waitForFinished(60000);
+    m_scriptTimings.append({m_currentFilename, script, timer.elapsed()});
+    if (!finished) {
         qCDebugFile(KCONF_UPDATE_LOG) << "update script did not terminate within 60 seconds:" << cmd;
         m_skip = true;
+        m_bHadFailures = true;
         return;
     }
     result = proc.exitCode();
@@ -352,10 +423,33 @@ void KonfUpdate::gotScript(const QString &_script)
 
     if (result != EXIT_SUCCESS) {
         qCDebug(KCONF_UPDATE_LOG) << m_currentFilename << ": !! An error occurred while running" << cmd;
+        m_bHadFailures = true;
         return;
     }
 
-    qCDebug(KCONF_UPDATE_LOG) << "Successfully ran" << cmd;
+    qCDebug(KCONF_UPDATE_LOG) << "Successfully ran" << cmd << "in" << m_scriptTimings.constLast().elapsedMs << "ms";
+}
+
+void KonfUpdate::reportScriptTimings() const
+{
+    if (m_scriptTimings.isEmpty()) {
+        return;
+    }
+
+    qint64 total = 0;
+    for (const ScriptTiming &timing : m_scriptTimings) {
+        total += timing.elapsedMs;
+    }
+    qCInfo(KCONF_UPDATE_LOG) << "Ran" << m_scriptTimings.size() << "update scripts in" << total << "ms";
+
+    // Slowest first, to show where login delays after an upgrade come from
+    QList<ScriptTiming> timings = m_scriptTimings;
+    std::sort(timings.begin(), timings.end(), [](const ScriptTiming &a, const ScriptTiming &b) {
+        return a.elapsedMs > b.elapsedMs;
+    });
+    for (const ScriptTiming &timing : std::as_const(timings)) {
+        qCDebug(KCONF_UPDATE_LOG).nospace() << timing.updateFile << ": " << timing.script << " took " << timing.elapsedMs << " ms";
+    }
 }
 
 int main(int argc, char **argv)
@@ -11,6 +11,7 @@
 #include <KCoreConfigSkeleton>
 #include <QJSValue>
 #include <QPointer>
+#include <QTimer>
 
 class KConfigPropertyMapPrivate
 {
@@ -28,10 +29,15 @@ public:
     void loadConfig(LoadConfigOption option);
     void writeConfig();
     void writeConfigValue(const QString &key, const QVariant &value);
+    void insertIfChanged(const QString &key, const QVariant &value, LoadConfigOption option);
 
     KConfigPropertyMap *q;
     QPointer<KCoreConfigSkeleton> config;
+    QTimer autoSaveTimer;
+    int autoSaveDelay = -1;
     bool updatingConfigValue = false;
+    // insertIfChanged() emits valueChanged() for the values it reads, those mustn't be written back
+    bool loadingConfig = false;
     bool notify = false;
 };
 
@@ -52,10 +58,22 @@ KConfigPropertyMap::KConfigPropertyMap(KCoreConfigSkeleton *config, QObject *par
         d->writeConfigValue(key, value);
     });
 
+    d->autoSaveTimer.setSingleShot(true);
+    connect(&d->autoSaveTimer, &QTimer::timeout, this, [this]() {
+        d->writeConfig();
+    });
+
     d->loadConfig(KConfigPropertyMapPrivate::DontEmitValueChanged);
 }
 
-KConfigPropertyMap::~KConfigPropertyMap() = default;
+KConfigPropertyMap::~KConfigPropertyMap()
+{
+    // don't lose changes still waiting for the automatic save
+    if (d->autoSaveTimer.isActive()) {
+        d->autoSaveTimer.stop();
+        d->writeConfig();
+    }
+}
 
 bool KConfigPropertyMap::isNotify() const
 {
@@ -67,8 +85,24 @@ void KConfigPropertyMap::setNotify(bool notify)
     d->notify = notify;
 }
 
+int KConfigPropertyMap::autoSaveDelay() const
+{
+    return d->autoSaveDelay;
+}
+
+void KConfigPropertyMap::setAutoSaveDelay(int msec)
+{
+    d->autoSaveDelay = msec;
+    if (msec < 0) {
+        d->autoSaveTimer.stop();
+    } else {
+        d->autoSaveTimer.setInterval(msec);
+    }
+}
+
 void KConfigPropertyMap::writeConfig()
 {
+    d->autoSaveTimer.stop();
     d->writeConfig();
 }
 
@@ -97,13 +131,24 @@ void KConfigPropertyMapPrivate::loadConfig(KConfigPropertyMapPrivate::LoadConfig
         return;
     }
 
+    // Only touch the values that changed, every insert() updates the bindings using the value
+    loadingConfig = true;
     const auto &items = config->items();
     for (KConfigSkeletonItem *item : items) {
-        q->insert(item->key() + QStringLiteral("Default"), item->getDefault());
-        q->insert(item->key(), item->property());
-        if (option == EmitValueChanged) {
-            Q_EMIT q->valueChanged(item->key(), item->property());
-        }
+        insertIfChanged(item->key() + QStringLiteral("Default"), item->getDefault(), DontEmitValueChanged);
+        insertIfChanged(item->key(), item->property(), option);
+    }
+    loadingConfig = false;
+}
+
+void KConfigPropertyMapPrivate::insertIfChanged(const QString &key, const QVariant &value, LoadConfigOption option)
+{
+    if (q->contains(key) && q->value(key) == value) {
+        return;
+    }
+    q->insert(key, value);
+    if (option == EmitValueChanged) {
+        Q_EMIT q->valueChanged(key, value);
     }
 }
 
@@ -115,20 +160,33 @@ void KConfigPropertyMapPrivate::writeConfig()
 
     const auto lstItems = config->items();
     for (KConfigSkeletonItem *item : lstItems) {
-        item->setWriteFlags(notify ? KConfigBase::Notify : KConfigBase::Normal);
-        item->setProperty(q->value(item->key()));
+        const QVariant value = q->value(item->key());
+        if (item->property() != value) {
+            item->setWriteFlags(notify ? KConfigBase::Notify : KConfigBase::Normal);
+            item->setProperty(value);
+        }
+    }
+    // Internally sync the config. This way we ensure the config file is written, even if the process crashed.
+    // Skipped if neither the items nor the KConfig of the skeleton, which may have been written directly, have changes.
+    if (config->isSaveNeeded() || config->config()->isDirty()) {
+        config->save();
     }
-    // Internally sync the config. This way we ensure the config file is written, even if the process crashed
-    config->save();
 }
 
 void KConfigPropertyMapPrivate::writeConfigValue(const QString &key, const QVariant &value)
 {
+    if (loadingConfig) {
+        // the value was just read from the config
+        return;
+    }
     if (KConfigSkeletonItem *item = config->findItem(key)) {
         updatingConfigValue = true;
         item->setWriteFlags(notify ? KConfigBase::Notify : KConfigBase::Normal);
         item->setProperty(value);
         updatingConfigValue = false;
+        if (autoSaveDelay >= 0) {
+            autoSaveTimer.start();
+        }
     }
 }
 
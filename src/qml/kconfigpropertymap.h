@@ -58,8 +58,34 @@ public:
      */
     Q_INVOKABLE bool isImmutable(const QString &key) const;
 
+    /*!
+     * Returns the delay in milliseconds after which changes are saved automatically,
+     * or a negative value if they aren't.
+     *
+     * \since 6.30
+     * \sa setAutoSaveDelay()
+     */
+    int autoSaveDelay() const;
+
+    /*!
+     * Saves changes made through the property map automatically, \a msec milliseconds
+     * after the last one. Changes made in quick succession, like those of a slider
+     * being dragged, are written together.
+     *
+     * Pending changes are saved when the property map is destroyed.
+     * A negative delay, the default, disables saving automatically.
+     *
+     * \since 6.30
+     * \sa writeConfig()
+     */
+    void setAutoSaveDelay(int msec);
+
     /*!
      * Saves the state of the property map to disk.
+     *
+     * Only the values that differ from the configuration are written.
+     * The file is left alone if there are none and the KConfig of the
+     * skeleton has no other unsaved changes.
      */
     Q_INVOKABLE void writeConfig();
 